@@ -121,6 +121,16 @@ def config_cache(options, system):
         system.l2 = l2_cache_class(clk_domain=system.cpu_clk_domain,
                                    **_get_cache_opts('l2', options))
 
+        if options.l2_rp_par:
+            # One partition per CPU, requests of a CPU and of its private
+            # caches are mapped to its partition by requestor name
+            system.l2.replacement_policy = ParRP(
+                replacement_policy=LRURP(),
+                par_config=[options.l2_assoc // options.num_cpus
+                            for _ in range(options.num_cpus)],
+                num_way=options.l2_assoc)
+            system.l2.par_requestors = [cpu.path() for cpu in system.cpu]
+
         system.tol2bus = L2XBar(clk_domain = system.cpu_clk_domain)
         system.l2.cpu_side = system.tol2bus.mem_side_ports
         system.l2.mem_side = system.membus.cpu_side_ports
@@ -129,7 +129,7 @@ system.voltage_domain = VoltageDomain(voltage = args.sys_voltage)
 system.clk_domain = SrcClockDomain(clock = "2GHz",
                                    voltage_domain = system.voltage_domain)
 # Create a seperate clock domain for Ruby
-system.ruby.clk_domain = SrcClockDomain(clock = "20GHz",
+system.ruby.clk_domain = SrcClockDomain(clock = "2GHz",
                                         voltage_domain = system.voltage_domain)
 
 #
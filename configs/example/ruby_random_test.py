@@ -108,7 +108,7 @@ cpu_list = [ system.cpu ] * args.num_cpus
 Ruby.create_system(args, False, system, cpus=cpu_list)
 
 # Create a seperate clock domain for Ruby
-system.ruby.clk_domain = SrcClockDomain(clock = "20GHz",
+system.ruby.clk_domain = SrcClockDomain(clock = "2GHz",
                                         voltage_domain = system.voltage_domain)
 
 assert(args.num_cpus == len(system.ruby._cpu_ports))
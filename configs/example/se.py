@@ -125,14 +125,11 @@ if '--ruby' in sys.argv:
 
 args = parser.parse_args()
 
-if buildEnv['PROTOCOL'] in 'EXCL' or buildEnv['PROTOCOL'] == 'INCL':
-    # override clock frequency settings for EXCL and INCL to simulate high speed bus in ruby system
+if buildEnv['PROTOCOL'] in ['EXCL', 'INCL', 'MSI']:
+    # the snooping bus network models the sub-cycle bus transfers itself,
+    # so ruby runs on the cpu clock
     args.cpu_clock = "2GHz"
-    args.ruby_clock = "4GHz"
-    args.sys_clock = "2GHz"
-elif buildEnv['PROTOCOL'] == 'MSI':
-    args.cpu_clock = "2GHz"
-    args.ruby_clock = "20GHz"
+    args.ruby_clock = "2GHz"
     args.sys_clock = "2GHz"
 
 multiprocesses = []
@@ -40,10 +40,15 @@ def define_options(parser):
     parser.add_argument(
         "--mesh-rows", type=int, default=0,
         help="the number of rows in the mesh topology")
+    # The snooping bus protocols come with their own network model
+    default_network = "simple"
+    if buildEnv['PROTOCOL'] in ['EXCL', 'INCL', 'MSI']:
+        default_network = "snooping"
     parser.add_argument(
-        "--network", default="simple",
-        choices=['simple', 'garnet'],
-        help="""'simple'|'garnet' (garnet2.0 will be deprecated.)""")
+        "--network", default=default_network,
+        choices=['simple', 'garnet', 'snooping'],
+        help="""'simple'|'garnet'|'snooping' (garnet2.0 will be deprecated.)
+            'snooping' is the bus of the EXCL, INCL and MSI protocols.""")
     parser.add_argument(
         "--router-latency", action="store", type=int,
         default=1,
@@ -103,6 +108,13 @@ def create_network(options, ruby):
         RouterClass = GarnetRouter
         InterfaceClass = GarnetNetworkInterface
 
+    elif options.network == "snooping":
+        NetworkClass = SnoopingBusNetwork
+        IntLinkClass = BasicIntLink
+        ExtLinkClass = BasicExtLink
+        RouterClass = BasicRouter
+        InterfaceClass = None
+
     else:
         NetworkClass = SimpleNetwork
         IntLinkClass = SimpleIntLink
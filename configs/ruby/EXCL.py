@@ -5,6 +5,7 @@ from m5.util import convert
 from m5.defines import buildEnv
 from .Ruby import create_topology
 from .Ruby import send_evicts
+from common import ObjectList
 import re
 
 
@@ -14,6 +15,7 @@ def define_options(parser):
     l2_latency = 10
     tdm_slot_width = 3
     resp_bus_slot_width = 3
+    bus_transfer_latency = 1
     parser.add_argument(
         "--l1-latency",
         type=int,
@@ -41,6 +43,49 @@ def define_options(parser):
         help="The number of busy cycles to transmit a response in the response bus"
     )
 
+    parser.add_argument(
+        "--bus-transfer-latency",
+        type=int,
+        default=bus_transfer_latency,
+        help="The number of cycles for a message on the bus to reach its destinations"
+    )
+
+    parser.add_argument(
+        "--tdm-arbitration",
+        choices=["strict", "work_conserving", "weighted", "hybrid"],
+        default="work_conserving",
+        help="Arbitration of the request bus slots: strict TDM, TDM skipping the cores without a request, "
+             "a weighted slot table, or slots guaranteed to the critical cores and spare ones to the others"
+    )
+
+    parser.add_argument(
+        "--tdm-slot-table",
+        default=None,
+        help="Owner core of each slot of the weighted and hybrid schedules, "
+             "given as a comma-separated list, e.g. 0,0,1,2 (-1 for a slot without owner)"
+    )
+
+    parser.add_argument(
+        "--tdm-critical-cores",
+        default=None,
+        help="Comma-separated list of the cores guaranteed their slots in the hybrid schedule"
+    )
+
+    parser.add_argument(
+        "--l1-mshrs",
+        type=int,
+        default=1,
+        help="Number of misses each L1 cache may have outstanding, "
+             "more than one needs a cpu model issuing several requests (e.g. O3CPU or MinorCPU)"
+    )
+
+    parser.add_argument(
+        "--llc-mem-requests",
+        type=int,
+        default=16,
+        help="Number of memory requests each LLC bank may have outstanding"
+    )
+
     parser.add_argument(
         "--num-l2-banks",
         type=int,
@@ -77,25 +122,22 @@ def create_system(
         fatal("This script requires EXCL build")
 
     options.topology = "SnoopingBus"
-    options.network = "simple"
-    
+    if options.network != "snooping":
+        fatal("This script requires the snooping bus network")
+
     if options.num_cpus < 1:
         fatal("This script requires at least one cpu")
 
-    if options.cpu_type != "TimingSimpleCPU":
-        fatal("This script requires TimingSimpleCPU cpu model")
+    if ObjectList.cpu_list.get(options.cpu_type).memory_mode() != "timing":
+        fatal("This script requires a timing cpu model")
+
+    if options.l1_mshrs < 1:
+        fatal("Each L1 cache needs at least one MSHR")
 
     num_llc_banks = options.num_l2_banks
     llc_size_in_bytes = convert.toMemorySize(options.l2_size)
     llc_bank_size = f'{int(llc_size_in_bytes / num_llc_banks)}B'
 
-    # To achieve short switch latency in ruby network, the ruby clock frequency is double of the cpu clock frequency.
-    # Thus, all the timing parameters in unit of clock cycle in ruby network must be doubled to account for this change.
-    options.l1_latency = options.l1_latency * 2
-    options.l2_latency = options.l2_latency * 2
-    options.tdm_slot_width = options.tdm_slot_width * 2
-    options.resp_bus_slot_width = options.resp_bus_slot_width * 2
-    
     cpu_sequencers = []
     l1_cntrl_nodes = []
 
@@ -138,7 +180,7 @@ def create_system(
             send_evictions=send_evicts(options),
             cache_access_latency=options.l1_latency,
             mandatory_queue_latency=options.l1_latency,
-            number_of_TBEs=1,
+            number_of_TBEs=options.l1_mshrs,
             profiler=profiler,
         )
         
@@ -148,7 +190,7 @@ def create_system(
             dcache=l1d_cache,
             clk_domain=clk_domain,
             ruby_system=ruby_system,
-            max_outstanding_requests=1
+            max_outstanding_requests=options.l1_mshrs
         )
 
         # Set sequencer in L1 controller
@@ -216,7 +258,7 @@ def create_system(
             ruby_system=ruby_system,
             cache_access_latency=options.l2_latency,
             profiler=profiler,
-            maxOutstandingMemRequests=16,
+            maxOutstandingMemRequests=options.llc_mem_requests,
         )
 
         # Set L2 controller in ruby system
@@ -279,6 +321,5 @@ def create_system(
         fatal("This script is missing full system support now")
     
     ruby_system.network.number_of_virtual_networks = 5
-    ruby_system.network.endpoint_bandwidth = 1000000
     topology = create_topology(all_cntrls, options)
     return (cpu_sequencers, [dir_cntrl], topology)
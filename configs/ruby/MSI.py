@@ -5,6 +5,7 @@ from m5.util import convert
 from m5.defines import buildEnv
 from .Ruby import create_topology
 from .Ruby import send_evicts
+from common import ObjectList
 import re
 
 
@@ -14,6 +15,7 @@ def define_options(parser):
     l2_latency = 10
     tdm_slot_width = 3
     resp_bus_slot_width = 3
+    bus_transfer_latency = 1
     parser.add_argument(
         "--l1-latency",
         type=int,
@@ -41,6 +43,42 @@ def define_options(parser):
         help="The number of busy cycles to transmit a response in the response bus"
     )
 
+    parser.add_argument(
+        "--bus-transfer-latency",
+        type=int,
+        default=bus_transfer_latency,
+        help="The number of cycles for a message on the bus to reach its destinations"
+    )
+
+    parser.add_argument(
+        "--tdm-arbitration",
+        choices=["strict", "work_conserving", "weighted", "hybrid"],
+        default="work_conserving",
+        help="Arbitration of the request bus slots: strict TDM, TDM skipping the cores without a request, "
+             "a weighted slot table, or slots guaranteed to the critical cores and spare ones to the others"
+    )
+
+    parser.add_argument(
+        "--tdm-slot-table",
+        default=None,
+        help="Owner core of each slot of the weighted and hybrid schedules, "
+             "given as a comma-separated list, e.g. 0,0,1,2 (-1 for a slot without owner)"
+    )
+
+    parser.add_argument(
+        "--tdm-critical-cores",
+        default=None,
+        help="Comma-separated list of the cores guaranteed their slots in the hybrid schedule"
+    )
+
+    parser.add_argument(
+        "--l1-mshrs",
+        type=int,
+        default=1,
+        help="Number of misses each L1 cache may have outstanding, "
+             "more than one needs a cpu model issuing several requests (e.g. O3CPU or MinorCPU)"
+    )
+
     parser.add_argument(
         "--num-l2-banks",
         type=int,
@@ -53,6 +91,22 @@ def define_options(parser):
         help='Enable omptr tracing'
     )
 
+    parser.add_argument(
+        "--omptr-raw-trace",
+        choices=["proto", "columnar"],
+        default=None,
+        help='Record the raw memory trace of every access instead of the per basic block stats, '
+             'one protobuf message per access or the compact columnar format'
+    )
+
+    parser.add_argument(
+        "--omptr-online",
+        action='store_true',
+        help='Classify the shared lines and compute the WCRT weights of the basic blocks during '
+             'the simulation instead of writing the per basic block stats '
+             '(the program must be built with -DOMPTR_ONLINE)'
+    )
+
     parser.add_argument(
         "--use-traffic-gen",
         action='store_true',
@@ -65,6 +119,46 @@ def define_options(parser):
         help='Enable LLC replacement policy partition'
     )
 
+    parser.add_argument(
+        "--llc-rp-par-kernel",
+        choices=["wrapped", "lru", "fifo", "tree-plru"],
+        default="wrapped",
+        help='Replacement policy used within LLC partitions: ParRP wrapping LRURP, or a native partitioned policy'
+    )
+
+    parser.add_argument(
+        "--llc-rp-par-resizable",
+        action='store_true',
+        help='Allow resizing the LLC partitions at runtime (m5 parmoveways, OMPTR_PAR_MOVE_WAYS, or ParRP.resize())'
+    )
+
+    parser.add_argument(
+        "--llc-rp-par-ucp",
+        action='store_true',
+        help='Size the LLC partitions automatically with a utility monitor (UCP)'
+    )
+
+    parser.add_argument(
+        "--llc-rp-par-ucp-period",
+        default='100us',
+        help='Period of the partition size updates of the utility monitor'
+    )
+
+    parser.add_argument(
+        "--llc-colors",
+        type=int,
+        default=0,
+        help='Split the LLC sets between this many page colors, a page gets the color of the first core touching it '
+             '(set partitioning, 0 disables it)'
+    )
+
+    parser.add_argument(
+        "--llc-rp-par-way-masks",
+        default=None,
+        help='Partition the LLC with way masks (CAT-style) instead of shared ownership, '
+             'given as a comma-separated list of masks, one per core, e.g. 0xff00,0x00ff'
+    )
+
 
 def create_system(
     options, full_system, system, dma_ports, bootmem, ruby_system, cpus
@@ -89,13 +183,17 @@ def create_system(
         fatal("This script requires MSI build")
 
     options.topology = "SnoopingBus"
-    options.network = "simple"
-    
+    if options.network != "snooping":
+        fatal("This script requires the snooping bus network")
+
     if options.num_cpus < 1:
         fatal("This script requires at least one cpu")
 
-    if options.cpu_type != "TimingSimpleCPU":
-        fatal("This script requires TimingSimpleCPU cpu model")
+    if ObjectList.cpu_list.get(options.cpu_type).memory_mode() != "timing":
+        fatal("This script requires a timing cpu model")
+
+    if options.l1_mshrs < 1:
+        fatal("Each L1 cache needs at least one MSHR")
 
     # if options.l2_assoc < options.num_cpus:
     #     fatal("L2 cache associativity must be at least the number of cpus")
@@ -104,13 +202,6 @@ def create_system(
     llc_size_in_bytes = convert.toMemorySize(options.l2_size)
     llc_bank_size = f'{int(llc_size_in_bytes / num_llc_banks)}B'
 
-    # To achieve short switch latency in ruby network, the ruby clock frequency is 10x of the cpu clock frequency.
-    # Thus, all the timing parameters in unit of clock cycle in ruby network becomes 10x larger to account for this change.
-    options.l1_latency = options.l1_latency * 10
-    options.l2_latency = options.l2_latency * 10
-    options.tdm_slot_width = options.tdm_slot_width * 10
-    options.resp_bus_slot_width = options.resp_bus_slot_width * 10
-    
     cpu_sequencers = []
     l1_cntrl_nodes = []
 
@@ -125,6 +216,11 @@ def create_system(
             mem_probe = CustomMemProbe(use_traffic_gen=options.use_traffic_gen)
         else:
             mem_probe = CustomMemProbe(use_traffic_gen=options.use_traffic_gen, cpus=cpus)
+        if options.omptr_raw_trace:
+            mem_probe.enable_raw_trace = True
+            mem_probe.columnar_trace = options.omptr_raw_trace == "columnar"
+        if options.omptr_online:
+            mem_probe.online_classification = True
         ruby_system.mem_probe = mem_probe
  
     # Create L1 cache controller
@@ -160,7 +256,7 @@ def create_system(
             send_evictions=send_evicts(options),
             cache_access_latency=options.l1_latency,
             mandatory_queue_latency=options.l1_latency,
-            number_of_TBEs=1,
+            number_of_TBEs=options.l1_mshrs,
             profiler=profiler,
             llc_use_par_rp=options.llc_rp_par
         )
@@ -171,7 +267,7 @@ def create_system(
             dcache=l1d_cache,
             clk_domain=clk_domain,
             ruby_system=ruby_system,
-            max_outstanding_requests=1,
+            max_outstanding_requests=options.l1_mshrs,
             coreid = i
         )
 
@@ -212,7 +308,23 @@ def create_system(
     for i in range(num_llc_banks):
         if options.llc_rp_par:
             par_config = [options.l2_assoc / options.num_cpus for _ in range(options.num_cpus)]
-            llc_rp = ParRP(replacement_policy=LRURP(), par_config=par_config, num_way=options.l2_assoc)
+            if options.llc_rp_par_way_masks:
+                assert options.llc_rp_par_kernel == "wrapped"
+                way_masks = [int(m, 0) for m in options.llc_rp_par_way_masks.split(",")]
+                assert len(way_masks) == options.num_cpus
+                llc_rp = ParRP(replacement_policy=LRURP(), num_way=options.l2_assoc, way_masks=way_masks)
+            elif options.llc_rp_par_kernel == "lru":
+                llc_rp = ParLRURP(par_config=par_config, num_way=options.l2_assoc)
+            elif options.llc_rp_par_kernel == "fifo":
+                llc_rp = ParFIFORP(par_config=par_config, num_way=options.l2_assoc)
+            elif options.llc_rp_par_kernel == "tree-plru":
+                llc_rp = ParTreePLRURP(par_config=par_config, num_way=options.l2_assoc)
+            else:
+                llc_rp = ParRP(replacement_policy=LRURP(), par_config=par_config, num_way=options.l2_assoc)
+            llc_rp.resizable = options.llc_rp_par_resizable or options.llc_rp_par_ucp
+            if options.llc_rp_par_ucp:
+                llc_rp.utility_monitor = ParUtilityMonitor(
+                    repartition_period=options.llc_rp_par_ucp_period)
         else:
             llc_rp = LRURP()
         
@@ -224,7 +336,10 @@ def create_system(
             tagArrayBanks=1,
             dataAccessLatency=options.l2_latency,
             tagAccessLatency=options.l2_latency,
-            replacement_policy=llc_rp
+            replacement_policy=llc_rp,
+            num_colors=options.llc_colors,
+            # the request port colors the pages on first touch
+            page_coloring=True
         )
         dir_memory = RubyDirectoryMemory()
         dir_memory.addr_ranges = [
@@ -315,6 +430,5 @@ def create_system(
         fatal("This script is missing full system support now")
     
     ruby_system.network.number_of_virtual_networks = 6
-    ruby_system.network.endpoint_bandwidth = 1000000
     topology = create_topology(all_cntrls, options)
     return (cpu_sequencers, [dir_cntrl], topology)
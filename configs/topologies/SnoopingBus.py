@@ -8,24 +8,24 @@ class SnoopingBus(SimpleTopology):
 
     def makeTopology(self, options, network, IntLink, ExtLink, Router):
 
-        # default values for link latency and router latency.
-        # Can be over-ridden on a per link/router basis
-        link_latency = options.link_latency # used by simple and garnet
-        router_latency = options.router_latency # only used by garnet
+        # The bus, its arbitration and its transfer latency are modeled by the
+        # SnoopingBusNetwork itself: the controllers are attached to a single
+        # router that only gives them a node in the topology.
+        bus = Router(router_id=0)
+        network.routers = bus
 
-        # Create an individual router for each controller plus one more for
-        # the centralized crossbar.  The large numbers of routers are needed
-        # because external links do not model outgoing bandwidth in the
-        # simple network, but internal links do.
-        # For garnet, one router suffices, use CrossbarGarnet.py
-
-        xbar = Router(router_id=0, num_processor=options.num_cpus, tdm_slot_width=options.tdm_slot_width, resp_bus_slot_width=options.resp_bus_slot_width)
-        
-        network.routers = xbar
-
-        ext_links = [ExtLink(link_id=i, ext_node=n, int_node=xbar, latency=link_latency)
+        ext_links = [ExtLink(link_id=i, ext_node=n, int_node=bus)
                         for (i, n) in enumerate(self.nodes)]
         network.ext_links = ext_links
 
         int_links = []
         network.int_links = int_links
+
+        network.tdm_slot_width = options.tdm_slot_width
+        network.resp_bus_slot_width = options.resp_bus_slot_width
+        network.tdm_arbitration = options.tdm_arbitration
+        network.transfer_latency = options.bus_transfer_latency
+        if options.tdm_slot_table:
+            network.tdm_slot_table = [int(c) for c in options.tdm_slot_table.split(",")]
+        if options.tdm_critical_cores:
+            network.tdm_critical_cores = [int(c) for c in options.tdm_critical_cores.split(",")]
@@ -76,6 +76,12 @@
 #define M5OP_WORK_BEGIN         0x5a
 #define M5OP_WORK_END           0x5b
 
+#define M5OP_PAR_MOVE_WAYS      0x5c
+#define M5OP_OMPTR_BB_START     0x5d
+#define M5OP_OMPTR_BB_END       0x5e
+#define M5OP_OMPTR_FORK         0x5f
+#define M5OP_OMPTR_JOIN         0x60
+
 #define M5OP_DIST_TOGGLE_SYNC   0x62
 
 #define M5OP_WORKLOAD           0x70
@@ -106,6 +112,11 @@
     M5OP(m5_panic, M5OP_PANIC)                                  \
     M5OP(m5_work_begin, M5OP_WORK_BEGIN)                        \
     M5OP(m5_work_end, M5OP_WORK_END)                            \
+    M5OP(m5_par_move_ways, M5OP_PAR_MOVE_WAYS)                  \
+    M5OP(m5_omptr_bb_start, M5OP_OMPTR_BB_START)                \
+    M5OP(m5_omptr_bb_end, M5OP_OMPTR_BB_END)                    \
+    M5OP(m5_omptr_fork, M5OP_OMPTR_FORK)                        \
+    M5OP(m5_omptr_join, M5OP_OMPTR_JOIN)                        \
     M5OP(m5_dist_toggle_sync, M5OP_DIST_TOGGLE_SYNC)            \
     M5OP(m5_workload, M5OP_WORKLOAD)                            \
 
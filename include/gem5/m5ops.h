@@ -67,6 +67,28 @@ void m5_panic(void);
 void m5_work_begin(uint64_t workid, uint64_t threadid);
 void m5_work_end(uint64_t workid, uint64_t threadid);
 
+/*
+ * Move ways from a partition of the partitioned LLC replacement policy
+ * to another. The partitions must be resizable.
+ */
+void m5_par_move_ways(uint64_t src_par_id, uint64_t dst_par_id,
+                      uint64_t num_ways);
+
+/*
+ * Mark the start and the end of an omptr basic block on the calling
+ * thread, for the memory access stats of the CustomMemProbe.
+ */
+void m5_omptr_bb_start(uint64_t bb_id);
+void m5_omptr_bb_end(void);
+
+/*
+ * Edges of the omptr DAG: bb_id creates a task starting with child_bb_id
+ * and continues with next_bb_id, or bb_id waits for the tasks it created
+ * and continues with next_bb_id.
+ */
+void m5_omptr_fork(uint64_t bb_id, uint64_t child_bb_id, uint64_t next_bb_id);
+void m5_omptr_join(uint64_t bb_id, uint64_t next_bb_id);
+
 /*
  * Send a very generic poke to the workload so it can do something. It's up to
  * the workload to know what information to look for to interpret an event,
@@ -1,7 +1,13 @@
 #include "analyzer.hh"
+#include "reachability.hh"
 #include <iostream>
 #include <fstream>
 #include <stack>
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <map>
+#include <sstream>
 
 void from_json(const json& j, BasicBlock& b) {
     j.at("ID").get_to(b.ID);
@@ -12,113 +18,64 @@ void from_json(const json& j, BasicBlock& b) {
     j.at("waitFor").get_to(b.waitFor);
 }
 
-void connected_components(const Graph& g, Vertex root, ComponentsMap& c_map) {
-    /**
-     * Compute the connected components of every vertex in a directed acyclic graph g
-     * A different vertex v is a connected vertex of u if there is a path from u to v in g
-     * If v is a connected vertex of u, c_map[u][v] is set to true otherwise false
-     * 
-     * The algorithm uses a DFS traversal on the root vertex to compute the connected components on a bottom-up sequence.
-     * Use C(u) to denote the set of connected vertex of u
-     * Then, C(u) = Union(C(v) for each target vertex v in out edges of u, set of target vertex v of u) 
-     */
-
-    std::stack<Vertex> dfs_stack;
-
-    // Vectors to keep track of DFS progress
-    std::vector<bool> discovered(boost::num_vertices(g), false);
-    std::vector<bool> done(boost::num_vertices(g), false);
-
-    // Push the starting vertex onto the stack and mark it as visited
-    dfs_stack.push(root);
-    discovered[root] = true;
-
-    // Perform DFS traversal
-    while (!dfs_stack.empty()) {
-        // Get the top vertex from the stack
-        Vertex current_vertex = dfs_stack.top();
-
-        // Get the out-edges of the current vertex
-        auto out_edges = boost::out_edges(current_vertex, g);
-
-        // Iterate over the out-edges to add undiscovered vertices to search stack
-        for (auto it = out_edges.first; it != out_edges.second; ++it) {
-            // Get the target vertex of the out-edge
-            Vertex target_vertex = boost::target(*it, g);
-
-            // If the target vertex hasn't been visited yet, push it onto the stack and mark it as visited
-            if (!discovered[target_vertex]) {
-                dfs_stack.push(target_vertex);
-                discovered[target_vertex] = true;
-            }
-        }
-
-        // Iterate over the out-edges again to determine if all children vertices are done
-        bool is_done = true;
-        for (auto it = out_edges.first; it != out_edges.second; ++it) {
-            // Get the target vertex of the out-edge
-            Vertex target_vertex = boost::target(*it, g);
-
-            // If the target vertex is not done, current vertex is not done;
-            if (!done[target_vertex]) {
-                is_done = false;
-            }
-        }
-
-        // If all children vertices are done, iterate over the out-edges again to process the current vertex
-        if (is_done) {
-            for (auto it = out_edges.first; it != out_edges.second; ++it) {
-                // Get the target vertex of the out-edge
-                int target_vertex = boost::target(*it, g);
-
-                c_map[current_vertex][target_vertex] = true;
-                for (Vertex i = 0; i < boost::num_vertices(g); ++i) {
-                    if (c_map[target_vertex][i] == true) {
-                        c_map[current_vertex][i] = true;
-                    }
-                }
-            }
-
-            done[current_vertex] = true;
-            dfs_stack.pop();
-        }
+// binary DAG written by omptr_print (omptr/omptr.h), after the magic number
+void parse_dag_binary(std::ifstream& file, std::vector<BasicBlock>& basic_blocks) {
+    uint32_t header[2];
+    uint64_t num_bbs;
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    file.read(reinterpret_cast<char*>(&num_bbs), sizeof(num_bbs));
+    if (!file || header[0] != 1) {
+        printf("[Error] unsupported binary DAG.\n");
+        exit(1);
     }
-}
-
-void connected_components_slow(const Graph& g, ComponentsMap& c_map) {
-    /**
-     * A slow version of connected components
-     * Simply perform DFS on each vertex to discover the connected vertices.
-     */
-
-    for (Vertex u = 0; u < boost::num_vertices(g); ++u) {
-        try {
-            boost::depth_first_search(g, 
-                boost::visitor(ConnectedComponentRecorder(c_map,u)).root_vertex(u));
-        } catch (const StopSearch&) {
-            continue;
+    basic_blocks.resize(num_bbs);
+    for (uint64_t i = 0; i < num_bbs; ++i) {
+        int32_t fields[4];
+        file.read(reinterpret_cast<char*>(fields), sizeof(fields));
+        BasicBlock& bb = basic_blocks[i];
+        bb.ID = i;
+        bb.taskID = fields[0];
+        bb.nodeID = fields[1];
+        bb.taskCreated = fields[2];
+        bb.numTasksWaitingFor = fields[3];
+        if (!file || bb.numTasksWaitingFor < 0) {
+            printf("[Error] truncated binary DAG.\n");
+            exit(1);
         }
+        bb.waitFor.resize(bb.numTasksWaitingFor);
+        file.read(reinterpret_cast<char*>(bb.waitFor.data()), bb.numTasksWaitingFor * sizeof(int32_t));
+    }
+    if (!file) {
+        printf("[Error] truncated binary DAG.\n");
+        exit(1);
     }
 }
 
 void parse_dag(std::string filename, Graph& g, Vertex& r, Vertex& e, int& num_tasks) {
     printf("Parsing DAG from %s...\n", filename.c_str());
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         printf("[Error] Unable to open file.\n");
         exit(1);
     }
 
-    json j;
-    try {
-        file >> j;
-    } catch (const std::exception& e) {
-        printf("[Error] exception happens when parsing JSON: %s\n", e.what());
+    std::vector<BasicBlock> basic_blocks_1d;
+    char magic[8] = {};
+    file.read(magic, sizeof(magic));
+    if (file.gcount() == sizeof(magic) && std::string(magic, sizeof(magic)) == DAG_MAGIC) {
+        parse_dag_binary(file, basic_blocks_1d);
+    } else {
+        file.clear();
+        file.seekg(0);
+        json j;
+        try {
+            file >> j;
+        } catch (const std::exception& e) {
+            printf("[Error] exception happens when parsing JSON: %s\n", e.what());
+        }
+        j.get_to(basic_blocks_1d);
     }
     file.close();
-
-    std::vector<BasicBlock> basic_blocks_1d;
-    j.get_to(basic_blocks_1d);
     std::sort(basic_blocks_1d.begin(), basic_blocks_1d.end());
 
     std::vector<std::vector<BasicBlock>> basic_blocks_2d;
@@ -128,30 +85,30 @@ void parse_dag(std::string filename, Graph& g, Vertex& r, Vertex& e, int& num_ta
     assert(current_task_id == 0);
     for (const auto& bb : basic_blocks_1d) {
         if (bb.taskID != current_task_id) {
-            basic_blocks_2d.push_back(bbs);
+            basic_blocks_2d.push_back(std::move(bbs));
             bbs.clear();
             assert(bb.taskID == current_task_id + 1);
             current_task_id = bb.taskID;
         }
         bbs.push_back(bb);
     }
-    basic_blocks_2d.push_back(bbs);
+    basic_blocks_2d.push_back(std::move(bbs));
 
     for (const auto& bbs : basic_blocks_2d) {
         for (const auto& bb : bbs) {
             // Add control flow edge
             if (bb.nodeID >= 1) {
-                BasicBlock last_bb = basic_blocks_2d[bb.taskID][bb.nodeID - 1];
+                const BasicBlock& last_bb = basic_blocks_2d[bb.taskID][bb.nodeID - 1];
                 boost::add_edge(last_bb.ID, bb.ID, g);
             }
             // Add task create edge
             if (bb.taskCreated != -1) {
-                BasicBlock created_bb = basic_blocks_2d[bb.taskCreated][0];
+                const BasicBlock& created_bb = basic_blocks_2d[bb.taskCreated][0];
                 boost::add_edge(bb.ID, created_bb.ID, g);
             }
             // Add synchronization edge
             for (const auto& task_id : bb.waitFor) {
-                BasicBlock last_bb = basic_blocks_2d[task_id].back();
+                const BasicBlock& last_bb = basic_blocks_2d[task_id].back();
                 boost::add_edge(last_bb.ID, bb.ID, g);
             }
         }
@@ -167,7 +124,6 @@ void parse_dag(std::string filename, Graph& g, Vertex& r, Vertex& e, int& num_ta
         std::vector<Vertex> container;
         boost::topological_sort(g, std::back_inserter(container));
         assert(container.back() == r);
-        assert(container.front() == e);
     } catch (boost::not_a_dag&) {
         printf("[Error] graph is not a DAG.\n");
         exit(1);
@@ -176,49 +132,107 @@ void parse_dag(std::string filename, Graph& g, Vertex& r, Vertex& e, int& num_ta
     printf("Done\n");
 }
 
-void parse_mem_stats(std::string filename, MemStats& mem_stats, std::vector<size_t>& exec_cycles_map) {
-    printf("Parsing memory stats from %s...\n", filename.c_str());
-    exec_cycles_map.clear();
-    ProtoInputStream *in_stream = new ProtoInputStream(filename);
-    ProtoMessage::AddrAccessStats msg;
-    int bb_id_counter = -1;
-    while (in_stream->read(msg)) {
-        int bb_id = msg.bb_id();
-        Addr line_address = msg.line_address();
-
-        if (bb_id == bb_id_counter + 1) {
-            bb_id_counter++;
-            mem_stats.push_back(std::map<Addr, AddrAccessStats>{});
+// build the memory stats from a raw trace in the columnar format, as the CustomMemProbe does
+void parse_mem_trace(std::string filename, MemStats& mem_stats) {
+    printf("Parsing memory trace from %s...\n", filename.c_str());
+    ColumnarTraceReader reader(filename);
+    std::vector<uint64_t> exec_cycles;
+    std::vector<uint8_t> has_metadata;
+    for (const BBExecCycles& bb : reader.bbExecCycles()) {
+        assert(bb.bb_id >= 0);
+        if ((size_t)bb.bb_id >= exec_cycles.size()) {
+            exec_cycles.resize(bb.bb_id + 1, 0);
+            has_metadata.resize(bb.bb_id + 1, 0);
         }
-        assert(bb_id == bb_id_counter);  // sanity check to ensure bb_id is in increasing order
+        assert(!has_metadata[bb.bb_id]);
+        exec_cycles[bb.bb_id] = bb.exec_cycles;
+        has_metadata[bb.bb_id] = 1;
+    }
 
-        if (msg.is_metadata()) {
-            exec_cycles_map.push_back(msg.exec_cycles());
-            continue;
+    // index of the stats of every line accessed by every basic block
+    std::vector<std::unordered_map<Addr, size_t>> index(exec_cycles.size());
+    std::vector<AddrAccessStats> stats;
+    std::vector<RawMemTrace> records;
+    for (size_t block = 0; block < reader.numBlocks(); ++block) {
+        reader.readBlock(block, records);
+        for (const RawMemTrace& record : records) {
+            // accesses outside basic blocks
+            if (record.bb_id == -1) {
+                continue;
+            }
+            assert((size_t)record.bb_id < index.size());
+            auto it = index[record.bb_id].find(record.line_address);
+            if (it == index[record.bb_id].end()) {
+                AddrAccessStats entry;
+                entry.line_address = record.line_address;
+                entry.num_local_l1_hit = 0;
+                entry.num_remote_l1_hit = 0;
+                entry.num_l2_hit = 0;
+                entry.num_memory_access = 0;
+                entry.bb_id = record.bb_id;
+                entry.thread_id = record.thread_id;
+                entry.data_region = static_cast<DataRegion>(record.data_region);
+                entry.is_ifetch = record.access_type == RAW_IFETCH;
+                entry.is_shared = false;  // to be populated later based on the DAG structure
+                it = index[record.bb_id].emplace(record.line_address, stats.size()).first;
+                stats.push_back(entry);
+            }
+            AddrAccessStats& entry = stats[it->second];
+            switch (record.hit_status) {
+                case RAW_LOCAL_L1_CACHE:
+                    entry.num_local_l1_hit++;
+                    break;
+                case RAW_REMOTE_L1_CACHE:
+                    entry.num_remote_l1_hit++;
+                    break;
+                case RAW_L2_CACHE:
+                    entry.num_l2_hit++;
+                    break;
+                case RAW_MEMORY:
+                    entry.num_memory_access++;
+                    break;
+            }
         }
+    }
+    std::vector<std::unordered_map<Addr, size_t>>().swap(index);
+    mem_stats.build(std::move(stats), std::move(exec_cycles), std::move(has_metadata));
+    printf("Done\n");
+}
 
-        auto it = mem_stats[bb_id].find(line_address);
-        if (it != mem_stats[bb_id].end()) {
-            assert(false);
-        } else {
-            AddrAccessStats entry;
-            entry.bb_id = msg.bb_id();
-            entry.thread_id = msg.thread_id();
-            entry.address = msg.line_address();
-            entry.line_address = msg.line_address();
-            entry.data_region = static_cast<DataRegion>(msg.data_region());
-            entry.is_ifetch = msg.is_ifetch();
-            entry.num_local_l1_hit = msg.num_local_l1_hit();
-            entry.num_remote_l1_hit = msg.num_remote_l1_hit();
-            entry.num_l2_hit = msg.num_l2_hit();
-            entry.num_memory_access = msg.num_memory_access();
-            entry.is_shared = false;  // to be populated later based on the DAG structure
-            mem_stats[bb_id].emplace(line_address, entry);
+void classify_shared_lines(std::vector<LineAccess>& accesses, const Reachability& reach) {
+    /**
+     * An access of a line is shared if the line is also accessed by a parallel basic block,
+     * unless both are data accesses from the same thread.
+     * Instructions are checked analytically even if the basic blocks are executed by the same thread.
+     */
+    std::sort(accesses.begin(), accesses.end(), [](const LineAccess& a, const LineAccess& b) {
+        return a.line_address < b.line_address;
+    });
+    size_t begin = 0;
+    while (begin < accesses.size()) {
+        size_t end = begin + 1;
+        while (end < accesses.size() && accesses[end].line_address == accesses[begin].line_address) {
+            ++end;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            AddrAccessStats& a = *accesses[i].stats;
+            if (a.is_shared) {
+                continue;
+            }
+            for (size_t j = begin; j < end; ++j) {
+                AddrAccessStats& b = *accesses[j].stats;
+                if (!a.is_ifetch && !b.is_ifetch && a.thread_id == b.thread_id) {
+                    continue;
+                }
+                if (reach.parallel(a.bb_id, b.bb_id)) {
+                    a.is_shared = true;
+                    b.is_shared = true;
+                    break;
+                }
+            }
         }
+        begin = end;
     }
-    assert(mem_stats.size() == exec_cycles_map.size());
-    delete in_stream;
-    printf("Done\n");
 }
 
 void analyze_shared_access(MemStats& mem_stats, Graph& g, const Vertex r, const Vertex e) {
@@ -227,225 +241,336 @@ void analyze_shared_access(MemStats& mem_stats, Graph& g, const Vertex r, const
     size_t num_bbs = mem_stats.size();
     assert(num_vertices == num_bbs);
 
-    printf("Computing connection map...\n");
-    ComponentsMap* c_map = new ComponentsMap(num_vertices, std::vector<bool>(num_vertices, false));
-    connected_components(g, r, *c_map);
+    printf("Computing reachability...\n");
+    Reachability reach(g, REACHABILITY_MAX_BITSET_BYTES, std::thread::hardware_concurrency());
+    size_t num_unjoined = 0;
     for (Vertex u = 0; u < boost::num_vertices(g); ++u) {
         // check every vertex is connected to the root
         if (u != r) {
-            assert((*c_map)[r][u] == true);
+            assert(reach.reachable(r, u));
         }
-        // check the exit vertex is connected to every vertex
-        if (u != e) {
-            assert((*c_map)[u][e] == true);
+        // the exit vertex is connected to every vertex, except those in tasks (or their descendants)
+        // that are never waited for, which stay parallel to everything after their creation
+        if (u != e && !reach.reachable(u, e)) {
+            num_unjoined++;
         }
     }
+    if (num_unjoined > 0) {
+        printf("[Warning] %ld basic blocks are in tasks never waited for.\n", num_unjoined);
+    }
     printf("Done\n");
     printf("Computing shared status...\n");
-    ProgressBar progressBar;
-    progressBar.init(mem_stats.size());
-    Vertex u = 0;
-    Tid tid = 0;
-    for (auto& addr_stats : mem_stats) {
-        // sanity check
-        if (addr_stats.size() != 0) {
-            auto it = addr_stats.begin();
-            tid = (it->second).thread_id;
+    // Inverted index: the accesses of every line, sharded by line so that the shards can be classified
+    // in parallel. Only the basic blocks that touched a line are checked against each other.
+    unsigned num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (!reach.usesBitsets()) {
+        // the interval labelling queries are not thread safe
+        num_threads = 1;
+    }
+    const size_t num_shards = num_threads * 16;
+    std::vector<std::vector<LineAccess>> shards(num_shards);
+    for (Vertex u = 0; u < num_bbs; ++u) {
+        Tid tid = 0;
+        if (!mem_stats[u].empty()) {
+            tid = mem_stats[u].begin()->thread_id;
+        }
+        for (AddrAccessStats& stats : mem_stats[u]) {
+            assert((Vertex)stats.bb_id == u);
+            assert(stats.thread_id == tid);
+            stats.is_shared = false;
+            shards[std::hash<Addr>()(stats.line_address) % num_shards].push_back({stats.line_address, &stats});
         }
+    }
 
-        std::vector<Vertex> parallel_vertices;
-        for (Vertex v = 0; v < num_vertices; ++v) {
-            if ((u != v) && ((*c_map)[u][v] == false) && ((*c_map)[v][u] == false)) {
-                parallel_vertices.push_back(v);
+    ProgressBar progressBar;
+    progressBar.init(num_shards);
+    std::atomic<size_t> next_shard(0);
+    std::atomic<size_t> num_shards_done(0);
+    auto classify_shards = [&](bool report_progress) {
+        size_t shard;
+        while ((shard = next_shard++) < num_shards) {
+            classify_shared_lines(shards[shard], reach);
+            size_t done = ++num_shards_done;
+            if (report_progress) {
+                progressBar.update(done);
             }
         }
-        
-        if (!parallel_vertices.empty()) {
-            // Small optimization:
-            // Vertex g is a vertex that is likely to have many parallel accesses
-            // with the current vertex under analysis.
-            // Try this vertex first to avoid exhaustly searching all parallel vertices.
-            // Use the first parallel vertex as the initial guess for g.
-            Vertex g = parallel_vertices[0];
-
-            for (auto& pair : addr_stats) {
-                assert((Vertex)pair.second.bb_id == u);
-                assert(pair.second.thread_id == tid);
-                
-                // if the access is shared, no need to process it again
-                if (pair.second.is_shared) {
-                    continue;
-                }
-
-                Addr line_address = pair.first;
-                bool is_ifetch = pair.second.is_ifetch;
-                bool is_shared = false;
-
-                if (!mem_stats[g].empty()) {
-                    auto it = mem_stats[g].begin();
-                    Tid g_tid = (it->second).thread_id;
-
-                    if (!(!is_ifetch && tid == g_tid)) {
-                        if (mem_stats[g].find(line_address) != mem_stats[g].end()) {
-                            // if access found in parallel node, the access is shared
-                            is_shared = true;
-                        }
-                    }
-                }
-                
-                if (!is_shared) {
-                    for (const Vertex& p : parallel_vertices) {
-                        if (mem_stats[p].size() == 0) {
-                            continue;
-                        }
-                        auto it = mem_stats[p].begin();
-                        Tid p_tid = (it->second).thread_id;
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < num_threads; ++t) {
+        threads.emplace_back(classify_shards, false);
+    }
+    classify_shards(true);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    progressBar.update(num_shards);
+    progressBar.done();
+    printf("Done\n");
+}
 
-                        // for instruction, check if it is shared analytically even if the node is executed by the same thread
-                        // for data, skip the check if the node is executed by the same thread
-                        if (!is_ifetch && tid == p_tid) {
-                            continue;
-                        }
+void default_sweep(const int num_cores, std::vector<SweepConfig>& sweep) {
+    // the configurations in the order of Configs
+    sweep.clear();
+    for (int i = 0; i < NUM_CONFIGS; ++i) {
+        SweepConfig config;
+        config.num_cores = num_cores;
+        default_wcls(num_cores, config.wcl_l1, config.wcl_llc, config.wcl_mem);
+        config.config = static_cast<Configs>(i);
+        sweep.push_back(config);
+    }
+}
 
-                        // if (tid == p_tid) {
-                        //     continue;
-                        // }
-
-                        it = mem_stats[p].find(line_address);
-                        if (it != mem_stats[p].end()) {
-                            // if access found in parallel node, the access is shared
-                            is_shared = true;
-                            // update the parallel access to be shared as well
-                            it->second.is_shared = true;
-                            g = p;  // Use p as a new guess for g.
-                            break;
-                        }
-                    }
-                }
-                pair.second.is_shared = is_shared;
+void parse_sweep_table(std::string filename, std::vector<SweepConfig>& sweep) {
+    /**
+     * One configuration per line: <num cores>,<WCL L1>,<WCL LLC>,<WCL memory>,<config>
+     * where config is one of CONFIG_NAMES. Empty lines and lines starting with # are skipped.
+     */
+    printf("Parsing sweep table from %s...\n", filename.c_str());
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        printf("[Error] Unable to open file %s.\n", filename.c_str());
+        exit(1);
+    }
+    sweep.clear();
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(field);
+        }
+        SweepConfig config;
+        bool valid = fields.size() == 5;
+        if (valid) {
+            try {
+                config.num_cores = std::stoi(fields[0]);
+                config.wcl_l1 = std::stoul(fields[1]);
+                config.wcl_llc = std::stoul(fields[2]);
+                config.wcl_mem = std::stoul(fields[3]);
+            } catch (const std::exception&) {
+                valid = false;
             }
         }
-        ++u;
-        progressBar.update(u);
+        if (valid) {
+            const char* const* name = std::find(CONFIG_NAMES, CONFIG_NAMES + NUM_CONFIGS, fields[4]);
+            valid = name != CONFIG_NAMES + NUM_CONFIGS && config.num_cores > 0;
+            config.config = static_cast<Configs>(name - CONFIG_NAMES);
+        }
+        if (!valid) {
+            printf("[Error] Invalid configuration at line %d of %s.\n", line_number, filename.c_str());
+            exit(1);
+        }
+        sweep.push_back(config);
+    }
+    if (sweep.empty()) {
+        printf("[Error] No configuration in %s.\n", filename.c_str());
+        exit(1);
     }
-    progressBar.done();
-    delete c_map;
     printf("Done\n");
 }
 
-void populate_vertex_weight(const MemStats& mem_stats, const std::vector<size_t>& exec_cycles_map, const int num_cores, std::vector<std::vector<size_t>>& weight_map) {
+void sweep_coefficients(const SweepConfig& config, size_t coefficients[NUM_ACCESS_CATEGORIES][NUM_HIT_LEVELS]) {
+    /**
+     * WCL of an access by category and level that served it
+     * isolated: the access is guaranteed to hit at the same level as observed
+     * unisolated: the access may be evicted by the other cores, i.e. every access may go to the memory
+     * shared partition: the shared data is kept in the LLC partition shared by the cores at best
+     */
+    const size_t isolated[NUM_HIT_LEVELS] = {config.wcl_l1, config.wcl_llc, config.wcl_mem};
+    const size_t unisolated[NUM_HIT_LEVELS] = {config.wcl_mem, config.wcl_mem, config.wcl_mem};
+    const size_t shared_partition[NUM_HIT_LEVELS] = {config.wcl_llc, config.wcl_llc, config.wcl_mem};
+    const size_t* wcls[NUM_ACCESS_CATEGORIES];
+    switch (config.config) {
+        case Configs::SHARE:
+            // simply sharing the LLC (no guarantee at all)
+            wcls[PRIVATE_INST] = unisolated;
+            wcls[SHARED_INST] = unisolated;
+            wcls[PRIVATE_DATA] = unisolated;
+            wcls[SHARED_DATA] = unisolated;
+            break;
+        case Configs::COLOR:
+            // perfect set coloring (preserve guarantee for private data but not for shared data)
+            wcls[PRIVATE_INST] = isolated;
+            wcls[SHARED_INST] = unisolated;
+            wcls[PRIVATE_DATA] = isolated;
+            wcls[SHARED_DATA] = unisolated;
+            break;
+        case Configs::PAR:
+            // our proposed llc partitioning technique (preserve guarantee for both private data and shared data)
+            wcls[PRIVATE_INST] = isolated;
+            wcls[SHARED_INST] = isolated;
+            wcls[PRIVATE_DATA] = isolated;
+            wcls[SHARED_DATA] = shared_partition;
+            break;
+        default:
+            // perfect set coloring + distinct address assignment for instruction (treat all instrcutions as private)
+            wcls[PRIVATE_INST] = isolated;
+            wcls[SHARED_INST] = isolated;
+            wcls[PRIVATE_DATA] = isolated;
+            wcls[SHARED_DATA] = unisolated;
+            break;
+    }
+    for (int i = 0; i < NUM_ACCESS_CATEGORIES; ++i) {
+        for (int j = 0; j < NUM_HIT_LEVELS; ++j) {
+            coefficients[i][j] = wcls[i][j];
+        }
+    }
+}
+
+void populate_vertex_weight(const MemStats& mem_stats, const std::vector<size_t>& exec_cycles_map, const std::vector<SweepConfig>& sweep, std::vector<size_t>& weight_map) {
+    /**
+     * The weight of a basic block in a configuration is a linear function of the number of accesses
+     * by category and hit level. The accesses are counted once per basic block, then the weights of
+     * all the configurations are accumulated together.
+     * weight_map[bb_id * sweep.size() + i] is the weight of basic block bb_id in configuration i.
+     */
     printf("Populate vertex weight...\n");
-    weight_map.clear();
-    // size_t total_exec_cycles = 0;
-    // for (size_t i = 0; i < exec_cycles_map.size(); ++i) {
-    //     total_exec_cycles += exec_cycles_map[i];
-    // }
-    // printf("total exection cycles: %ld\n", total_exec_cycles);
-
-    size_t wcl_mem = 1;
-    size_t wcl_l1 = 1;
-    size_t wcl_llc = 1;
-    if (num_cores == 2) {
-        wcl_l1 = 1;
-        wcl_llc = 87;
-        wcl_mem = 568;
-    } else if (num_cores == 4) {
-        wcl_l1 = 1;
-        wcl_llc = 175;
-        wcl_mem = 1063;
-    } else {
-        wcl_l1 = 1;
-        wcl_llc = 431;
-        wcl_mem = 2065;
+    const size_t num_configs = sweep.size();
+    const size_t num_counters = NUM_ACCESS_CATEGORIES * NUM_HIT_LEVELS;
+    // coefficients of counter j at [j * num_configs, (j + 1) * num_configs)
+    std::vector<size_t> coefficients(num_counters * num_configs);
+    for (size_t i = 0; i < num_configs; ++i) {
+        size_t config_coefficients[NUM_ACCESS_CATEGORIES][NUM_HIT_LEVELS];
+        sweep_coefficients(sweep[i], config_coefficients);
+        for (size_t j = 0; j < num_counters; ++j) {
+            coefficients[j * num_configs + i] = config_coefficients[j / NUM_HIT_LEVELS][j % NUM_HIT_LEVELS];
+        }
     }
+
+    weight_map.assign(mem_stats.size() * num_configs, 0);
     for (size_t bb_id = 0; bb_id < mem_stats.size(); ++bb_id) {
-        size_t exec_cycles = exec_cycles_map[bb_id];
-        size_t bb_wcl_share = 0;  // WCL if simply sharing the LLC (no guarantee at all)
-        size_t bb_wcl_color = 0;  // WCL if using perfect set coloring (preserve guarantee for private data but not for shared data)
-        size_t bb_wcl_par = 0;  // WCL if using our proposed llc partitioning technique (preserve guarantee for both private data and shared data)
-        size_t bb_wcl_color_pri_inst = 0;  // WCL if using perfect set coloring + distinct address assignment for instruction (set coloring + treat all instrcutions as private)
-        
-        for (const auto& pair : mem_stats[bb_id]) {
-            size_t total_access_times = pair.second.num_local_l1_hit + pair.second.num_remote_l1_hit + 
-                pair.second.num_l2_hit + pair.second.num_memory_access;
-            size_t l1_hit_times = pair.second.num_local_l1_hit;
-            size_t llc_hit_times = pair.second.num_remote_l1_hit + pair.second.num_l2_hit;
-            size_t mem_access_times = pair.second.num_memory_access;
-            if (pair.second.is_ifetch) {
-                if (pair.second.is_shared) {
-                    // shared instruction
-                    bb_wcl_share += total_access_times * wcl_mem;
-                    bb_wcl_color += total_access_times * wcl_mem;
-                    bb_wcl_par += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                    bb_wcl_color_pri_inst += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                } else {
-                    // private instruction
-                    bb_wcl_share += total_access_times * wcl_mem;
-                    bb_wcl_color += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                    bb_wcl_par += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                    bb_wcl_color_pri_inst += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                }
+        size_t counters[NUM_ACCESS_CATEGORIES][NUM_HIT_LEVELS] = {};
+        for (const AddrAccessStats& stats : mem_stats[bb_id]) {
+            AccessCategory category;
+            if (stats.is_ifetch) {
+                category = stats.is_shared ? SHARED_INST : PRIVATE_INST;
             } else {
-                if (pair.second.is_shared) {
-                    // shared data
-                    bb_wcl_share += total_access_times * wcl_mem;
-                    bb_wcl_color += total_access_times * wcl_mem;
-                    bb_wcl_par += (l1_hit_times + llc_hit_times) * wcl_llc + mem_access_times * wcl_mem;
-                    bb_wcl_color_pri_inst += total_access_times * wcl_mem;
-                } else {
-                    // private data
-                    bb_wcl_share += total_access_times * wcl_mem;
-                    bb_wcl_color += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                    bb_wcl_par += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                    bb_wcl_color_pri_inst += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-                }
+                category = stats.is_shared ? SHARED_DATA : PRIVATE_DATA;
+            }
+            counters[category][L1_HIT] += stats.num_local_l1_hit;
+            counters[category][LLC_HIT] += stats.num_remote_l1_hit + stats.num_l2_hit;
+            counters[category][MEMORY_ACCESS] += stats.num_memory_access;
+        }
+
+        size_t* weights = &weight_map[bb_id * num_configs];
+        for (size_t i = 0; i < num_configs; ++i) {
+            weights[i] = exec_cycles_map[bb_id];
+        }
+        for (size_t j = 0; j < num_counters; ++j) {
+            size_t count = counters[j / NUM_HIT_LEVELS][j % NUM_HIT_LEVELS];
+            if (count == 0) {
+                continue;
+            }
+            const size_t* counter_coefficients = &coefficients[j * num_configs];
+            for (size_t i = 0; i < num_configs; ++i) {
+                weights[i] += counter_coefficients[i] * count;
             }
         }
-        std::vector<size_t> weights(NUM_CONFIGS, 0);
-        weights[Configs::SHARE] = bb_wcl_share + exec_cycles;
-        weights[Configs::COLOR] = bb_wcl_color + exec_cycles;
-        weights[Configs::PAR] = bb_wcl_par + exec_cycles;
-        weights[Configs::COLOR_PRIVATE_INST] = bb_wcl_color_pri_inst + exec_cycles;
-        weight_map.push_back(weights);
     }
     printf("Done\n");
 }
 
-void compute_WCRTs(const Graph& g, const std::vector<std::vector<size_t>>& weight_map, const int num_cores, std::vector<size_t>& wcrts, std::vector<size_t>& critical_paths, std::vector<size_t>& volumes) {
+void compute_WCRTs(const Graph& g, const std::vector<size_t>& weight_map, const std::vector<SweepConfig>& sweep, std::vector<size_t>& wcrts, std::vector<size_t>& critical_paths, std::vector<size_t>& volumes) {
     printf("Computing WCRTs (Graham's bound)...\n");
-    wcrts.clear();
-    critical_paths.clear();
-    volumes.clear();
+    const size_t num_configs = sweep.size();
+    const size_t num_vertices = boost::num_vertices(g);
     std::vector<Vertex> sorted_vertices;
     boost::topological_sort(g, std::back_inserter(sorted_vertices));
-    // size_t critical_paths[NUM_CONFIGS];
-    for (int i = 0; i < NUM_CONFIGS; ++i) {
-        std::vector<size_t> longest_path(boost::num_vertices(g), 0);
-        for (auto vi = sorted_vertices.begin(); vi != sorted_vertices.end(); ++vi) {
-            for (auto ei = boost::out_edges(*vi, g).first; ei != boost::out_edges(*vi, g).second; ++ei) {
-                Vertex target_vertex = boost::target(*ei, g);
-                longest_path[*vi] = std::max(longest_path[*vi], weight_map[*vi][i] + longest_path[target_vertex]);
+
+    // longest paths of all the configurations in one pass, longest_path[v * num_configs + i]
+    std::vector<size_t> longest_path(num_vertices * num_configs, 0);
+    for (auto vi = sorted_vertices.begin(); vi != sorted_vertices.end(); ++vi) {
+        size_t* path = &longest_path[*vi * num_configs];
+        const size_t* weights = &weight_map[*vi * num_configs];
+        for (auto ei = boost::out_edges(*vi, g).first; ei != boost::out_edges(*vi, g).second; ++ei) {
+            Vertex target_vertex = boost::target(*ei, g);
+            const size_t* target_path = &longest_path[target_vertex * num_configs];
+            for (size_t i = 0; i < num_configs; ++i) {
+                path[i] = std::max(path[i], weights[i] + target_path[i]);
             }
         }
-        assert(longest_path.front() != 0);
-        critical_paths.push_back(longest_path.front());
     }
+    critical_paths.assign(longest_path.begin(), longest_path.begin() + num_configs);
 
-    // size_t volumes[NUM_CONFIGS];
-    for (int i = 0; i < NUM_CONFIGS; ++i) {
-        volumes.push_back(0);
-        for (size_t j = 0; j < weight_map.size(); ++j) {
-            volumes[i] += weight_map[j][i];
+    volumes.assign(num_configs, 0);
+    for (size_t v = 0; v < num_vertices; ++v) {
+        const size_t* weights = &weight_map[v * num_configs];
+        for (size_t i = 0; i < num_configs; ++i) {
+            volumes[i] += weights[i];
         }
     }
 
-    for (int i = 0; i < NUM_CONFIGS; ++i) {
-        double wcrt = critical_paths[i] + (double)(volumes[i] - critical_paths[i]) / num_cores;
+    wcrts.clear();
+    for (size_t i = 0; i < num_configs; ++i) {
+        assert(critical_paths[i] != 0);
+        double wcrt = critical_paths[i] + (double)(volumes[i] - critical_paths[i]) / sweep[i].num_cores;
         wcrts.push_back((size_t) wcrt);
     }
     printf("Done\n");
 }
 
+void write_sweep_results(std::string filename, const std::vector<SweepConfig>& sweep, const std::vector<size_t>& wcrts, const std::vector<size_t>& critical_paths, const std::vector<size_t>& volumes) {
+    printf("Outputing sweep results...\n");
+    std::ofstream file(filename);
+
+    if (!file.is_open()) {
+        printf("[Error] Unable to open file %s to write.\n", filename.c_str());
+        exit(1);
+    }
+
+    file << "#cores,WCL(L1),WCL(LLC),WCL(MEM),config,WCRT,critical path,volume" << std::endl;
+    for (size_t i = 0; i < sweep.size(); ++i) {
+        file << sweep[i].num_cores << ","
+             << sweep[i].wcl_l1 << ","
+             << sweep[i].wcl_llc << ","
+             << sweep[i].wcl_mem << ","
+             << CONFIG_NAMES[sweep[i].config] << ","
+             << wcrts[i] << ","
+             << critical_paths[i] << ","
+             << volumes[i] << std::endl;
+    }
+    file.close();
+    printf("Done\n");
+}
+
+void write_line_classification(const MemStats& mem_stats, std::string filename) {
+    /**
+     * Every line with the number of basic blocks accessing it and the number of those whose accesses are shared,
+     * in the format of the lines.csv of the online classification of the CustomMemProbe.
+     */
+    printf("Outputing line classification...\n");
+    std::map<Addr, std::pair<size_t, size_t>> lines;
+    for (size_t bb_id = 0; bb_id < mem_stats.size(); ++bb_id) {
+        for (const AddrAccessStats& stats : mem_stats[bb_id]) {
+            std::pair<size_t, size_t>& line = lines[stats.line_address];
+            line.first++;
+            if (stats.is_shared) {
+                line.second++;
+            }
+        }
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        printf("[Error] Unable to open file %s to write.\n", filename.c_str());
+        exit(1);
+    }
+    file << "#line address,BBs,shared BBs" << std::endl;
+    for (const auto& line : lines) {
+        file << "0x" << std::hex << line.first << std::dec << ","
+             << line.second.first << "," << line.second.second << "\n";
+    }
+    file.close();
+    printf("Done\n");
+}
+
 void collect_statistics(MemStats& mem_stats, Graph& g, std::string filename, const int num_tasks, const std::vector<size_t> wcrts, const std::vector<size_t> critical_paths, const std::vector<size_t>& volumes) {
     printf("Outputing statistics...\n");
     size_t num_private_inst = 0;
@@ -455,27 +580,27 @@ void collect_statistics(MemStats& mem_stats, Graph& g, std::string filename, con
     size_t num_shared_stack = 0;
     size_t num_shared_heap = 0;
 
-    for (const auto& addr_stats : mem_stats) {
-        for (const auto& pair : addr_stats) {
-            size_t access_times = pair.second.num_local_l1_hit + pair.second.num_remote_l1_hit + 
-                pair.second.num_l2_hit + pair.second.num_memory_access;
-            if (pair.second.is_ifetch) {
-                if (pair.second.is_shared) {
+    for (size_t bb_id = 0; bb_id < mem_stats.size(); ++bb_id) {
+        for (const AddrAccessStats& stats : mem_stats[bb_id]) {
+            size_t access_times = stats.num_local_l1_hit + stats.num_remote_l1_hit + 
+                stats.num_l2_hit + stats.num_memory_access;
+            if (stats.is_ifetch) {
+                if (stats.is_shared) {
                     num_shared_inst += access_times;
                 } else {
                     num_private_inst += access_times;
                 }
             } else {
-                switch (pair.second.data_region) {
+                switch (stats.data_region) {
                     case DataRegion::STACK:
-                        if (pair.second.is_shared) {
+                        if (stats.is_shared) {
                             num_shared_stack += access_times;
                         } else {
                             num_private_stack += access_times;
                         }
                         break;
                     default:
-                        if (pair.second.is_shared) {
+                        if (stats.is_shared) {
                             num_shared_heap += access_times;
                         } else {
                             num_private_heap += access_times;
@@ -533,32 +658,65 @@ void collect_statistics(MemStats& mem_stats, Graph& g, std::string filename, con
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 5) {
-        std::cerr << "Usage: " << argv[0] << " <mem stats file> <dag structure json> <num cores> <output csv>" << std::endl;
+    bool sweep_mode = argc >= 2 && std::string(argv[1]) == "--sweep";
+    int num_args = sweep_mode ? argc - 1 : argc;
+    if (num_args != 5 && num_args != 6) {
+        std::cerr << "Usage: " << argv[0] << " <mem stats file> <dag structure json> <num cores> <output csv> [<lines csv>]" << std::endl;
+        std::cerr << "       " << argv[0] << " --sweep <mem stats file> <dag structure json> <sweep table> <output csv> [<lines csv>]" << std::endl;
+        std::cerr << "       the mem stats file can also be a columnar raw trace (.ctrc)" << std::endl;
+        std::cerr << "       the dag structure can also be a binary DAG written by the omptr runtime (.dag)" << std::endl;
+        std::cerr << "       the sweep table has a configuration per line: <num cores>,<WCL L1>,<WCL LLC>,<WCL memory>,<config>" << std::endl;
+        std::cerr << "       the lines csv gets the classification of every line, as written by the online classification" << std::endl;
         return 1;
     }
 
-    std::string mem_stats_file = argv[1];
-    std::string dag_structure_json = argv[2];
-    int num_cores = std::stoi(argv[3]);
-    std::string output_csv = argv[4];
+    int arg = sweep_mode ? 2 : 1;
+    std::string mem_stats_file = argv[arg];
+    std::string dag_structure_json = argv[arg + 1];
+    std::vector<SweepConfig> sweep;
+    if (sweep_mode) {
+        parse_sweep_table(argv[arg + 2], sweep);
+    } else {
+        default_sweep(std::stoi(argv[arg + 2]), sweep);
+    }
+    std::string output_csv = argv[arg + 3];
+    std::string lines_csv = num_args == 6 ? argv[arg + 4] : "";
 
     MemStats *mem_stats = new MemStats();
     Graph *g = new Graph();
-    std::vector<size_t> exec_cycles_map;
-    parse_mem_stats(mem_stats_file, *mem_stats, exec_cycles_map);
+    // runs with other core counts reuse the parsed stats from the cache file
+    if (!mem_stats->loadCache(mem_stats_file)) {
+        const std::string ctrc_suffix = ".ctrc";
+        if (mem_stats_file.size() >= ctrc_suffix.size() &&
+            mem_stats_file.compare(mem_stats_file.size() - ctrc_suffix.size(), ctrc_suffix.size(), ctrc_suffix) == 0) {
+            parse_mem_trace(mem_stats_file, *mem_stats);
+        } else {
+            mem_stats->parse(mem_stats_file, std::thread::hardware_concurrency());
+        }
+        mem_stats->saveCache(mem_stats_file);
+    }
+    // sanity check to ensure every basic block ended
+    assert(mem_stats->allBBsEnded());
+    std::vector<size_t> exec_cycles_map(mem_stats->execCycles().begin(), mem_stats->execCycles().end());
     Vertex r;
     Vertex e;
     int num_tasks;
     parse_dag(dag_structure_json, *g, r, e, num_tasks);
     analyze_shared_access(*mem_stats, *g, r, e);
-    std::vector<std::vector<size_t>> weight_map;
-    populate_vertex_weight(*mem_stats, exec_cycles_map, num_cores, weight_map);
+    if (!lines_csv.empty()) {
+        write_line_classification(*mem_stats, lines_csv);
+    }
+    std::vector<size_t> weight_map;
+    populate_vertex_weight(*mem_stats, exec_cycles_map, sweep, weight_map);
     std::vector<size_t> wcrts;
     std::vector<size_t> critical_paths;
     std::vector<size_t> volumes;
-    compute_WCRTs(*g, weight_map, num_cores, wcrts, critical_paths, volumes);
-    collect_statistics(*mem_stats, *g, output_csv, num_tasks, wcrts, critical_paths, volumes);
+    compute_WCRTs(*g, weight_map, sweep, wcrts, critical_paths, volumes);
+    if (sweep_mode) {
+        write_sweep_results(output_csv, sweep, wcrts, critical_paths, volumes);
+    } else {
+        collect_statistics(*mem_stats, *g, output_csv, num_tasks, wcrts, critical_paths, volumes);
+    }
     delete mem_stats;
     delete g;
     return 0;
@@ -5,6 +5,8 @@
 
 #include "proto/protoio.hh"
 #include "proto/custom_mem_trace.pb.h"
+#include "columnar_trace.hh"
+#include "mem_stats.hh"
 #include "json.hpp"
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/topological_sort.hpp>
@@ -17,15 +19,6 @@
 
 using json = nlohmann::json;
 
-typedef uint64_t Addr; 
-typedef int Tid;
-
-enum DataRegion {
-    GLOBAL,
-    STACK,
-    HEAP
-};
-
 enum Configs {
     SHARE,
     COLOR,
@@ -35,21 +28,58 @@ enum Configs {
 
 #define NUM_CONFIGS 4
 
-typedef struct AddrAccessStats {
-    int bb_id;
-    Tid thread_id;
-    Addr address;
-    Addr line_address;
-    bool is_ifetch;
-    uint64_t num_local_l1_hit;
-    uint64_t num_remote_l1_hit;
-    uint64_t num_l2_hit;
-    uint64_t num_memory_access;
-    DataRegion data_region;
-    bool is_shared;
-} AddrAccessStats;
+// names of the configurations in the sweep tables
+const char* const CONFIG_NAMES[NUM_CONFIGS] = {"SHARE", "COLOR", "PAR", "COLOR_PRIVATE_INST"};
+
+// a configuration of a WCRT sweep: number of cores, worst-case latencies of the platform and LLC management
+typedef struct SweepConfig {
+    int num_cores;
+    size_t wcl_l1;
+    size_t wcl_llc;
+    size_t wcl_mem;
+    Configs config;
+} SweepConfig;
+
+// accesses of a basic block by sharing status and level that serves them
+enum AccessCategory {
+    PRIVATE_INST,
+    SHARED_INST,
+    PRIVATE_DATA,
+    SHARED_DATA
+};
+
+#define NUM_ACCESS_CATEGORIES 4
 
-typedef std::vector<std::map<Addr, AddrAccessStats>> MemStats;
+enum HitLevel {
+    L1_HIT,
+    LLC_HIT,  // remote L1 or L2 hit
+    MEMORY_ACCESS
+};
+
+#define NUM_HIT_LEVELS 3
+
+// worst-case latencies measured on the platforms with 2, 4 and 8 cores (8 for any other number of cores)
+inline void default_wcls(int num_cores, size_t& wcl_l1, size_t& wcl_llc, size_t& wcl_mem) {
+    if (num_cores == 2) {
+        wcl_l1 = 1;
+        wcl_llc = 87;
+        wcl_mem = 568;
+    } else if (num_cores == 4) {
+        wcl_l1 = 1;
+        wcl_llc = 175;
+        wcl_mem = 1063;
+    } else {
+        wcl_l1 = 1;
+        wcl_llc = 431;
+        wcl_mem = 2065;
+    }
+}
+
+// an access of a line in the inverted index of the memory stats
+typedef struct LineAccess {
+    Addr line_address;
+    AddrAccessStats* stats;
+} LineAccess;
 
 typedef struct BasicBlock {
     int ID;
@@ -73,36 +103,11 @@ typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> Graph;
 typedef boost::graph_traits<Graph>::vertex_descriptor Vertex;
 typedef boost::graph_traits<Graph>::edge_descriptor Edge;
 
-typedef std::vector<std::vector<bool>> ComponentsMap;
-
-class StopSearch : public std::exception 
-{
-};
-
-// Custom visitor to record the connected components found by DFS
-struct ConnectedComponentRecorder : boost::default_dfs_visitor {
-    ComponentsMap& c_map;
-    Vertex src;
-    ConnectedComponentRecorder(ComponentsMap& c_map, Vertex src) : c_map(c_map), src(src)
-    {
-    }
-
-    void discover_vertex(Vertex u, const Graph& g) {
-        if (u != src) {
-            c_map[src][u] = true;
-        }
-    }
-
-    void back_edge(Edge e, const Graph& g) {
-        assert(false);
-    }
+// magic number of the binary DAGs written by the omptr runtime
+#define DAG_MAGIC "OMPTRDAG"
 
-    void finish_vertex(Vertex u, const Graph& g) {
-        if (u == src) {
-            throw StopSearch();
-        }
-    }
-};
+// memory budget of the reachability bitsets of the DAG, larger DAGs use interval labelling
+#define REACHABILITY_MAX_BITSET_BYTES (4ULL << 30)
 
 class ProgressBar {
 public:
@@ -1,206 +1,475 @@
 #include "analyzer.hh"
 #include <iostream>
 #include <fstream>
-#include <stack>
-
-void parse_mem_stats(std::string filename, MemStats& mem_stats) {
-    printf("Parsing memory stats from %s...\n", filename.c_str());
-    ProtoInputStream *in_stream = new ProtoInputStream(filename);
-    ProtoMessage::AddrAccessStats msg;
-    int bb_id_counter = -1;
-    while (in_stream->read(msg)) {
-        int bb_id = msg.bb_id();
-        Addr line_address = msg.line_address();
-
-        if (bb_id == bb_id_counter + 1) {
-            bb_id_counter++;
-            mem_stats.push_back(std::map<Addr, AddrAccessStats>{});
-        }
-        assert(bb_id == bb_id_counter);
-
-        auto it = mem_stats[bb_id].find(line_address);
-        if (it != mem_stats[bb_id].end()) {
-            it->second.num_local_l1_hit += msg.num_local_l1_hit();
-            it->second.num_remote_l1_hit += msg.num_remote_l1_hit();
-            it->second.num_l2_hit += msg.num_l2_hit();
-            it->second.num_memory_access += msg.num_memory_access();
-        } else {
-            AddrAccessStats entry;
-            entry.bb_id = msg.bb_id();
-            entry.thread_id = msg.thread_id();
-            entry.address = msg.line_address();
-            entry.line_address = msg.line_address();
-            entry.data_region = static_cast<DataRegion>(msg.data_region());
-            entry.is_ifetch = msg.is_ifetch();
-            entry.num_local_l1_hit = msg.num_local_l1_hit();
-            entry.num_remote_l1_hit = msg.num_remote_l1_hit();
-            entry.num_l2_hit = msg.num_l2_hit();
-            entry.num_memory_access = msg.num_memory_access();
-            entry.is_shared = false;  // to be populated later based on the DAG structure
-            mem_stats[bb_id].emplace(line_address, entry);
-        }
-    }
-    delete in_stream;
-    printf("Done\n");
+#include <sstream>
+#include <atomic>
+#include <cstdarg>
+#include <functional>
+#include <map>
+#include <queue>
+
+// names of the data regions in the reports, in the order of DataRegion
+#define NUM_DATA_REGIONS 3
+const char* const DATA_REGION_NAMES[NUM_DATA_REGIONS] = {"GLOBAL", "STACK", "HEAP"};
+
+// the bb_id of the stats is the core id with the traffic generator
+#define MAX_NUM_CORES 64
+
+// a check of the stats of a run against the stats of the run in isolation
+typedef struct CheckConfig {
+    std::string iso_mem_stats_file;
+    std::string mem_stats_file;
+    bool partition_enable;
+    std::string log_file;  // empty for the standard output
+} CheckConfig;
+
+// the cores accessing a line in a run
+typedef struct LineCores {
+    Addr line_address;
+    uint64_t cores;
+} LineCores;
+
+typedef struct RegionReport {
+    size_t num_private;
+    size_t num_private_violations;
+    size_t num_shared;
+    size_t num_shared_violations;
+} RegionReport;
+
+typedef struct CoreReport {
+    int core_id;
+    std::string trace_error;  // empty if the traces of the core are the same
+    RegionReport regions[NUM_DATA_REGIONS];
+    size_t wcrt;
+} CoreReport;
+
+// exit codes of a check
+enum CheckStatus {
+    EXPECTED = 0,             // no violation with the partitioned LLC, a violation with the shared LLC
+    UNEXPECTED_PASS = 1,      // no violation with the shared LLC
+    UNEXPECTED_FAIL = 2,      // a violation with the partitioned LLC
+    MISSING_DATA = 3,         // a core accessed no private or no shared line
+    TRACE_MISMATCH = 255      // the traces of the two runs are different
+};
+
+// architecture latencies of the WCRT
+typedef struct Latencies {
+    int num_cores;
+    size_t wcl_l1;
+    size_t wcl_llc;
+    size_t wcl_mem;
+} Latencies;
+
+void parse_mem_stats(std::string filename, MemStats& mem_stats, unsigned num_threads) {
+    // later runs reuse the parsed stats from the cache file
+    if (!mem_stats.loadCache(filename)) {
+        mem_stats.parse(filename, num_threads);
+        mem_stats.saveCache(filename);
+    }
 }
 
-void analyze_shared_access(MemStats& mem_stats) {
-    assert(!mem_stats.empty());
-    auto& cua_mem_stats = mem_stats[0];
-    for (auto& pair : cua_mem_stats) {
-        Addr line_address = pair.first;
-        for (size_t core_id = 1; core_id < mem_stats.size(); core_id++) {
-            if (mem_stats[core_id].find(line_address) != mem_stats[core_id].end()) {
-                // if address is found in other cores' access traces, mark it as shared
-                pair.second.is_shared = true;
-            }
+void run_parallel(size_t num_jobs, unsigned num_threads, const std::function<void(size_t)>& job) {
+    // the threads claim the jobs in order
+    std::atomic<size_t> next_job(0);
+    auto worker = [&]() {
+        size_t j;
+        while ((j = next_job++) < num_jobs) {
+            job(j);
         }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < std::min<size_t>(num_threads, num_jobs); ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
     }
 }
 
-void compute_wcrt(MemStats& mem_stats, bool partition_enable) {
-    printf("Computing WCRT...\n");
-    // TODO: plug in the following architectural number
-    int num_cores = 8;
-    size_t wcl_mem = 1;
-    size_t wcl_l1 = 1;
-    size_t wcl_llc = 1;
-    if (num_cores == 2) {
-        wcl_l1 = 1;
-        wcl_llc = 87;
-        wcl_mem = 568;
-    } else if (num_cores == 4) {
-        wcl_l1 = 1;
-        wcl_llc = 175;
-        wcl_mem = 1063;
-    } else {
-        wcl_l1 = 1;
-        wcl_llc = 431;
-        wcl_mem = 2065;
-    }
-    assert(!mem_stats.empty());
-    auto& cua_mem_stats = mem_stats[0];
-    size_t wcrt = 0;
-    for (auto& pair : cua_mem_stats) {
-        size_t total_access_times = pair.second.num_local_l1_hit + pair.second.num_remote_l1_hit + 
-                pair.second.num_l2_hit + pair.second.num_memory_access;
-        size_t l1_hit_times = pair.second.num_local_l1_hit;
-        size_t llc_hit_times = pair.second.num_remote_l1_hit + pair.second.num_l2_hit;
-        assert(pair.second.num_remote_l1_hit == 0);
-        size_t mem_access_times = pair.second.num_memory_access;
-        if (partition_enable) {
-            if (pair.second.is_shared) {
-                wcrt += (l1_hit_times + llc_hit_times) * wcl_llc + mem_access_times * wcl_mem;
-            } else {
-                wcrt += l1_hit_times * wcl_l1 + llc_hit_times * wcl_llc + mem_access_times * wcl_mem;
-            }
-        } else {
-            wcrt += total_access_times * wcl_mem;
+void append_printf(std::string& report, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    report += buffer;
+}
+
+void analyze_shared_access(const MemStats& mem_stats, std::vector<LineCores>& line_cores) {
+    /**
+     * The cores accessing every line, by a k-way merge of the sorted stats of the cores.
+     * A line of a core is shared if it is also accessed by another core.
+     */
+    if (mem_stats.size() > MAX_NUM_CORES) {
+        printf("[Error] More than %d cores in the mem stats.\n", MAX_NUM_CORES);
+        exit(1);
+    }
+    typedef std::pair<Addr, size_t> Head;  // line address, core id
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<const AddrAccessStats*> next(mem_stats.size());
+    for (size_t core_id = 0; core_id < mem_stats.size(); ++core_id) {
+        next[core_id] = mem_stats[core_id].begin();
+        if (next[core_id] != mem_stats[core_id].end()) {
+            heads.push(Head(next[core_id]->line_address, core_id));
+        }
+    }
+    line_cores.clear();
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        if (line_cores.empty() || line_cores.back().line_address != head.first) {
+            LineCores entry = {head.first, 0};
+            line_cores.push_back(entry);
+        }
+        line_cores.back().cores |= 1ULL << head.second;
+        if (++next[head.second] != mem_stats[head.second].end()) {
+            heads.push(Head(next[head.second]->line_address, head.second));
         }
     }
-    printf("WCRT is %ld\n", wcrt);
 }
 
-void check(MemStats& iso_mem_stats, MemStats& mem_stats, bool partition_enable) {
-    printf("Checking...\n");
-    assert(!mem_stats.empty());
-    assert(!iso_mem_stats.empty());
-    auto& cua_mem_stats = mem_stats[0];
-    auto& iso_cua_mem_stats = iso_mem_stats[0];
-    if (cua_mem_stats.size() != iso_cua_mem_stats.size()) {
-        printf("[Error]: traces are different (reason: #accessed address are different).\n");
-        exit(-1);
-    }
-    // first do sanity check to make sure the traces are the same
-    for (auto& pair : iso_cua_mem_stats) {
-        Addr line_address = pair.first;
-        auto it = cua_mem_stats.find(line_address);
-        if (it == cua_mem_stats.end()) {
-            printf("[Error]: traces are different (reason: accessed address are different).\n");
-            exit(-1);
-        }
-        size_t access_times = it->second.num_local_l1_hit + it->second.num_remote_l1_hit + 
-                it->second.num_l2_hit + it->second.num_memory_access;
-        size_t iso_access_times = pair.second.num_local_l1_hit + pair.second.num_remote_l1_hit + 
-                pair.second.num_l2_hit + pair.second.num_memory_access;
+void check_core(const MemStats& iso_mem_stats, const MemStats& mem_stats, const std::vector<LineCores>& line_cores,
+                bool partition_enable, const Latencies& latencies, CoreReport& report) {
+    /**
+     * Merge-join of the sorted stats of the core in the two runs (and of the cores of the lines):
+     * the traces must be the same, then
+     * - a private line must have the same number of L1 hits and LLC hits,
+     * - a shared line must have the same number of memory accesses.
+     */
+    int core_id = report.core_id;
+    report.trace_error.clear();
+    for (int r = 0; r < NUM_DATA_REGIONS; ++r) {
+        report.regions[r] = RegionReport();
+    }
+    report.wcrt = 0;
+    if ((size_t)core_id >= iso_mem_stats.size() || (size_t)core_id >= mem_stats.size()) {
+        report.trace_error = "core is missing";
+        return;
+    }
+    const BBStats iso_core_stats = iso_mem_stats[core_id];
+    const BBStats core_stats = mem_stats[core_id];
+    if (core_stats.size() != iso_core_stats.size()) {
+        report.trace_error = "#accessed address are different";
+        return;
+    }
+
+    const LineCores* line = line_cores.data();
+    const uint64_t other_cores = ~(1ULL << core_id);
+    const AddrAccessStats* it = core_stats.begin();
+    for (const AddrAccessStats& stats : iso_core_stats) {
+        if (it->line_address != stats.line_address) {
+            report.trace_error = "accessed address are different";
+            return;
+        }
+        size_t access_times = it->num_local_l1_hit + it->num_remote_l1_hit +
+                it->num_l2_hit + it->num_memory_access;
+        size_t iso_access_times = stats.num_local_l1_hit + stats.num_remote_l1_hit +
+                stats.num_l2_hit + stats.num_memory_access;
         if (access_times != iso_access_times) {
-            printf("[Error]: traces are different (reason: accessed times for an address are different).\n");
-            exit(-1);
+            report.trace_error = "accessed times for an address are different";
+            return;
         }
-    }
 
-    bool private_data_detected = false;
-    bool private_data_check_res = true;
-    bool shared_data_detected = false;
-    bool shared_data_check_res = true;
+        while (line->line_address < it->line_address) {
+            ++line;
+        }
+        assert(line->line_address == it->line_address);
+        bool is_shared = (line->cores & other_cores) != 0;
 
-    // traces are the same, now proceed to isolation property check
-    for (auto& pair : iso_cua_mem_stats) {
-        Addr line_address = pair.first;
-        auto it = cua_mem_stats.find(line_address);
-        if (it->second.is_shared) {
-            shared_data_detected = true;
+        RegionReport& region = report.regions[it->data_region];
+        size_t l1_hit_times = it->num_local_l1_hit;
+        size_t llc_hit_times = it->num_remote_l1_hit + it->num_l2_hit;
+        size_t mem_access_times = it->num_memory_access;
+        if (is_shared) {
             // for shared data, make sure the number of memory access are equal
-            size_t iso_num_memory_access = pair.second.num_memory_access;
-            size_t num_memory_access = it->second.num_memory_access;
-
-            if (num_memory_access != iso_num_memory_access) {
-                shared_data_check_res = false;
+            region.num_shared++;
+            if (it->num_memory_access != stats.num_memory_access) {
+                region.num_shared_violations++;
             }
         } else {
-            private_data_detected = true;
             // for private data, make sure the number of l1 hit and llc hit are the same
-            size_t iso_l1_hit= pair.second.num_local_l1_hit;
-            size_t iso_llc_hit = pair.second.num_l2_hit;
-            size_t num_l1_hit = it->second.num_local_l1_hit;
-            size_t num_llc_hit = it->second.num_l2_hit;
-            if ((iso_l1_hit != num_l1_hit) || (iso_llc_hit != num_llc_hit)) {
-                private_data_check_res = false;
+            region.num_private++;
+            if (it->num_local_l1_hit != stats.num_local_l1_hit || it->num_l2_hit != stats.num_l2_hit) {
+                region.num_private_violations++;
             }
         }
+
+        if (partition_enable) {
+            if (is_shared) {
+                report.wcrt += (l1_hit_times + llc_hit_times) * latencies.wcl_llc + mem_access_times * latencies.wcl_mem;
+            } else {
+                report.wcrt += l1_hit_times * latencies.wcl_l1 + llc_hit_times * latencies.wcl_llc +
+                        mem_access_times * latencies.wcl_mem;
+            }
+        } else {
+            report.wcrt += access_times * latencies.wcl_mem;
+        }
+        ++it;
+    }
+}
+
+CheckStatus report_check(const CheckConfig& config, const std::vector<CoreReport>& cores, std::string& report) {
+    append_printf(report, "Checking %s against %s...\n", config.mem_stats_file.c_str(), config.iso_mem_stats_file.c_str());
+    append_printf(report, "partition enable %d\n", config.partition_enable);
+    for (const CoreReport& core : cores) {
+        if (!core.trace_error.empty()) {
+            append_printf(report, "[Error]: traces of core %d are different (reason: %s).\n", core.core_id,
+                          core.trace_error.c_str());
+            return TRACE_MISMATCH;
+        }
     }
-    assert(private_data_detected);
-    assert(shared_data_detected);
+
+    bool private_data_check_res = true;
+    bool shared_data_check_res = true;
+    bool missing_data = false;
+    for (const CoreReport& core : cores) {
+        append_printf(report, "Core %d:\n", core.core_id);
+        append_printf(report, "  %-8s %14s %10s %14s %10s\n", "region", "private lines", "violations",
+                      "shared lines", "violations");
+        RegionReport total = RegionReport();
+        for (int r = 0; r < NUM_DATA_REGIONS; ++r) {
+            const RegionReport& region = core.regions[r];
+            append_printf(report, "  %-8s %14zu %10zu %14zu %10zu\n", DATA_REGION_NAMES[r], region.num_private,
+                          region.num_private_violations, region.num_shared, region.num_shared_violations);
+            total.num_private += region.num_private;
+            total.num_private_violations += region.num_private_violations;
+            total.num_shared += region.num_shared;
+            total.num_shared_violations += region.num_shared_violations;
+        }
+        append_printf(report, "  WCRT is %zu\n", core.wcrt);
+        if (total.num_private == 0 || total.num_shared == 0) {
+            append_printf(report, "[Error]: core %d accessed no %s data.\n", core.core_id,
+                          total.num_private == 0 ? "private" : "shared");
+            missing_data = true;
+        }
+        private_data_check_res = private_data_check_res && total.num_private_violations == 0;
+        shared_data_check_res = shared_data_check_res && total.num_shared_violations == 0;
+    }
+    if (missing_data) {
+        return MISSING_DATA;
+    }
+
     if (private_data_check_res && shared_data_check_res) {
-        if (!partition_enable) {
-            printf("Unexpected: property violation is not observed in config of shared LLC\n");
-            exit(1);
+        if (!config.partition_enable) {
+            append_printf(report, "Unexpected: property violation is not observed in config of shared LLC\n");
+            return UNEXPECTED_PASS;
         }
-        printf("Result: Passed\n");
-        return;
+        append_printf(report, "Result: Passed\n");
+        return EXPECTED;
     }
-    if (partition_enable) {
-        printf("Unexpected: property violation is observed in config of partitioned LLC\n");
-        exit(2);
+    if (config.partition_enable) {
+        append_printf(report, "Unexpected: property violation is observed in config of partitioned LLC\n");
+        return UNEXPECTED_FAIL;
     }
-    printf("Result: Failed\n");
+    append_printf(report, "Result: Failed\n");
     if (!private_data_check_res) {
-        printf("Reason: difference in private data hit status detected\n");
+        append_printf(report, "Reason: difference in private data hit status detected\n");
     }
     if (!shared_data_check_res) {
-        printf("Reason: difference in shared data hit status detected\n");
+        append_printf(report, "Reason: difference in shared data hit status detected\n");
+    }
+    return EXPECTED;
+}
+
+void parse_check_list(std::string filename, std::vector<CheckConfig>& configs) {
+    /**
+     * One check per line: <isolation mem stats file> <mem stats file> <partition enable> [log file]
+     * Empty lines and lines starting with # are skipped.
+     */
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        printf("[Error] Unable to open file %s.\n", filename.c_str());
+        exit(1);
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::stringstream ss(line);
+        CheckConfig config;
+        int partition_enable = -1;
+        ss >> config.iso_mem_stats_file >> config.mem_stats_file >> partition_enable;
+        if (ss.fail() || (partition_enable != 0 && partition_enable != 1)) {
+            printf("[Error] Invalid check at line %d of %s.\n", line_number, filename.c_str());
+            exit(1);
+        }
+        config.partition_enable = partition_enable == 1;
+        ss >> config.log_file;
+        configs.push_back(config);
     }
-    return;
+}
+
+bool parse_core_list(std::string list, std::vector<int>& cores) {
+    // "all" (empty list) or comma separated core ids
+    cores.clear();
+    if (list == "all") {
+        return true;
+    }
+    std::stringstream ss(list);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        try {
+            cores.push_back(std::stoi(field));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (cores.back() < 0 || cores.back() >= MAX_NUM_CORES) {
+            return false;
+        }
+    }
+    return !cores.empty();
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <isolation mem stats file> <mem stats file> <partition enable: 1 if partition enabled 0 otherwise>" << std::endl;
+    Latencies latencies;
+    latencies.num_cores = 8;
+    bool custom_wcls = false;
+    std::vector<int> cores_to_check(1, 0);  // the core under analysis
+    unsigned num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string check_list;
+    std::vector<std::string> positional;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--num-cores" && has_value) {
+            latencies.num_cores = std::atoi(argv[++i]);
+            valid = latencies.num_cores > 0;
+        } else if (arg == "--wcl" && has_value) {
+            valid = sscanf(argv[++i], "%zu,%zu,%zu", &latencies.wcl_l1, &latencies.wcl_llc, &latencies.wcl_mem) == 3;
+            custom_wcls = true;
+        } else if (arg == "--cores" && has_value) {
+            valid = parse_core_list(argv[++i], cores_to_check);
+        } else if (arg == "--threads" && has_value) {
+            num_threads = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--sweep" && has_value) {
+            check_list = argv[++i];
+        } else if (arg.compare(0, 2, "--") != 0) {
+            positional.push_back(arg);
+        } else {
+            valid = false;
+        }
+    }
+    bool sweep_mode = !check_list.empty();
+    if (!valid || positional.size() != (sweep_mode ? 0u : 3u)) {
+        std::cerr << "Usage: " << argv[0] << " [options] <isolation mem stats file> <mem stats file> <partition enable: 1 if partition enabled 0 otherwise>" << std::endl;
+        std::cerr << "       " << argv[0] << " [options] --sweep <check list>" << std::endl;
+        std::cerr << "       the check list has a check per line: <isolation mem stats file> <mem stats file> <partition enable> [log file]" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "       --num-cores <n>          number of cores of the platform of the WCLs (default 8)" << std::endl;
+        std::cerr << "       --wcl <l1>,<llc>,<mem>   worst-case latencies (default: measured for the number of cores)" << std::endl;
+        std::cerr << "       --cores <all|c0,c1,...>  cores to check (default 0, the core under analysis)" << std::endl;
+        std::cerr << "       --threads <n>            number of threads (default: number of hardware threads)" << std::endl;
+        return 1;
+    }
+    if (!custom_wcls) {
+        default_wcls(latencies.num_cores, latencies.wcl_l1, latencies.wcl_llc, latencies.wcl_mem);
+    }
+
+    std::vector<CheckConfig> configs;
+    if (sweep_mode) {
+        parse_check_list(check_list, configs);
+    } else {
+        CheckConfig config;
+        config.iso_mem_stats_file = positional[0];
+        config.mem_stats_file = positional[1];
+        config.partition_enable = std::stoi(positional[2]) == 1;
+        configs.push_back(config);
+    }
+
+    // parse every stats file once, e.g. the isolation run is shared by the configurations of a seed
+    std::map<std::string, size_t> file_index;
+    std::vector<std::string> files;
+    for (const CheckConfig& config : configs) {
+        const std::string* names[2] = {&config.iso_mem_stats_file, &config.mem_stats_file};
+        for (const std::string* name : names) {
+            if (file_index.insert(std::make_pair(*name, files.size())).second) {
+                files.push_back(*name);
+            }
+        }
+    }
+    std::vector<MemStats> mem_stats(files.size());
+    unsigned parse_threads = std::max(num_threads / (unsigned)files.size(), 1u);
+    run_parallel(files.size(), num_threads, [&](size_t f) {
+        parse_mem_stats(files[f], mem_stats[f], parse_threads);
+    });
+
+    // the cores of the lines of every run
+    std::vector<size_t> runs;
+    std::vector<size_t> run_index(files.size(), 0);
+    for (const CheckConfig& config : configs) {
+        size_t f = file_index[config.mem_stats_file];
+        if (std::find(runs.begin(), runs.end(), f) == runs.end()) {
+            run_index[f] = runs.size();
+            runs.push_back(f);
+        }
+    }
+    std::vector<std::vector<LineCores>> line_cores(runs.size());
+    run_parallel(runs.size(), num_threads, [&](size_t r) {
+        analyze_shared_access(mem_stats[runs[r]], line_cores[r]);
+    });
+
+    // one job per check and core
+    std::vector<std::vector<CoreReport>> core_reports(configs.size());
+    std::vector<std::pair<size_t, size_t>> jobs;
+    for (size_t c = 0; c < configs.size(); ++c) {
+        std::vector<int> cores = cores_to_check;
+        if (cores.empty()) {
+            // all the cores of the isolation run
+            const MemStats& iso_mem_stats = mem_stats[file_index[configs[c].iso_mem_stats_file]];
+            for (size_t core_id = 0; core_id < iso_mem_stats.size() && core_id < MAX_NUM_CORES; ++core_id) {
+                if (!iso_mem_stats[core_id].empty()) {
+                    cores.push_back(core_id);
+                }
+            }
+        }
+        core_reports[c].resize(cores.size());
+        for (size_t i = 0; i < cores.size(); ++i) {
+            core_reports[c][i].core_id = cores[i];
+            jobs.push_back(std::make_pair(c, i));
+        }
+    }
+    run_parallel(jobs.size(), num_threads, [&](size_t j) {
+        const CheckConfig& config = configs[jobs[j].first];
+        size_t run = file_index[config.mem_stats_file];
+        check_core(mem_stats[file_index[config.iso_mem_stats_file]], mem_stats[run], line_cores[run_index[run]],
+                   config.partition_enable, latencies, core_reports[jobs[j].first][jobs[j].second]);
+    });
+
+    std::vector<CheckStatus> statuses;
+    for (size_t c = 0; c < configs.size(); ++c) {
+        std::string report;
+        statuses.push_back(report_check(configs[c], core_reports[c], report));
+        if (configs[c].log_file.empty()) {
+            printf("%s", report.c_str());
+        } else {
+            std::ofstream log(configs[c].log_file);
+            if (!log.is_open()) {
+                printf("[Error] Unable to open file %s to write.\n", configs[c].log_file.c_str());
+                exit(1);
+            }
+            log << report;
+        }
+    }
+    if (!sweep_mode) {
+        return statuses[0];
+    }
+
+    size_t num_passed = std::count(statuses.begin(), statuses.end(), EXPECTED);
+    printf("All checks completed: %zu out of %zu passed\n", num_passed, configs.size());
+    if (num_passed != configs.size()) {
+        printf("Failed checks:\n");
+        for (size_t c = 0; c < configs.size(); ++c) {
+            if (statuses[c] != EXPECTED) {
+                printf("%s %s %d: retcode %d\n", configs[c].iso_mem_stats_file.c_str(),
+                       configs[c].mem_stats_file.c_str(), configs[c].partition_enable, statuses[c]);
+            }
+        }
         return 1;
     }
-    std::string iso_mem_stats_file = argv[1];
-    std::string mem_stats_file = argv[2];
-    bool partition_enable = (std::stoi(argv[3]) == 1);
-    printf("partition enable %d\n", partition_enable);
-
-    MemStats *iso_mem_stats = new MemStats();
-    MemStats *mem_stats = new MemStats();
-    parse_mem_stats(iso_mem_stats_file, *iso_mem_stats);
-    parse_mem_stats(mem_stats_file, *mem_stats);
-    analyze_shared_access(*mem_stats);
-    check(*iso_mem_stats, *mem_stats, partition_enable);
-    compute_wcrt(*mem_stats, partition_enable);
-    delete iso_mem_stats;
-    delete mem_stats;
     return 0;
 }
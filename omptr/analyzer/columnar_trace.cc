@@ -0,0 +1,214 @@
+#include "columnar_trace.hh"
+
+#include <zlib.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char HEADER_MAGIC[] = "OMPTRCT1";
+const char FOOTER_MAGIC[] = "OMPTRCTE";
+const size_t HEADER_SIZE = 16;
+const size_t FOOTER_SIZE = 40;
+const int NUM_COLUMNS = 5;
+
+uint32_t getU32(const uint8_t* p) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= (uint32_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+uint64_t getU64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= (uint64_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+// sequential decoder of a column
+struct ColumnDecoder {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        int shift = 0;
+        while (true) {
+            if (p == end || shift > 63) {
+                std::cerr << "Corrupted column in the columnar trace" << std::endl;
+                exit(1);
+            }
+            uint8_t byte = *p++;
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+            shift += 7;
+        }
+    }
+
+    int64_t zigzag() {
+        uint64_t value = varint();
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+};
+
+}  // namespace
+
+ColumnarTraceReader::ColumnarTraceReader(const std::string& filename) : filename(filename) {
+    file = fopen(filename.c_str(), "rb");
+    if (file == NULL) {
+        error("cannot open the file");
+    }
+
+    uint8_t header[HEADER_SIZE];
+    readBytes(0, header, HEADER_SIZE);
+    if (memcmp(header, HEADER_MAGIC, 8) != 0) {
+        error("not a columnar trace");
+    }
+    lineBits = getU32(header + 8);
+    compressed = getU32(header + 12) & 1;
+
+    if (fseeko(file, 0, SEEK_END) != 0) {
+        error("cannot seek");
+    }
+    uint64_t file_size = ftello(file);
+    if (file_size < HEADER_SIZE + FOOTER_SIZE) {
+        error("truncated file");
+    }
+    uint8_t footer[FOOTER_SIZE];
+    readBytes(file_size - FOOTER_SIZE, footer, FOOTER_SIZE);
+    if (memcmp(footer + 32, FOOTER_MAGIC, 8) != 0) {
+        error("missing footer, the simulation may not have exited cleanly");
+    }
+
+    uint64_t bb_metadata_offset = getU64(footer);
+    uint64_t num_bb_metadata = getU64(footer + 8);
+    std::vector<uint8_t> buffer(num_bb_metadata * 16);
+    readBytes(bb_metadata_offset, buffer.data(), buffer.size());
+    bbMetadata.resize(num_bb_metadata);
+    for (uint64_t i = 0; i < num_bb_metadata; ++i) {
+        bbMetadata[i].bb_id = (int32_t)getU32(&buffer[i * 16]);
+        bbMetadata[i].thread_id = (int32_t)getU32(&buffer[i * 16 + 4]);
+        bbMetadata[i].exec_cycles = getU64(&buffer[i * 16 + 8]);
+    }
+
+    uint64_t block_index_offset = getU64(footer + 16);
+    uint64_t num_blocks = getU64(footer + 24);
+    buffer.resize(num_blocks * 20);
+    readBytes(block_index_offset, buffer.data(), buffer.size());
+    blockIndex.resize(num_blocks);
+    for (uint64_t i = 0; i < num_blocks; ++i) {
+        blockIndex[i].offset = getU64(&buffer[i * 20]);
+        blockIndex[i].first_record = getU64(&buffer[i * 20 + 8]);
+        blockIndex[i].num_records = getU32(&buffer[i * 20 + 16]);
+    }
+}
+
+ColumnarTraceReader::~ColumnarTraceReader() {
+    fclose(file);
+}
+
+uint64_t ColumnarTraceReader::numRecords() const {
+    if (blockIndex.empty()) {
+        return 0;
+    }
+    return blockIndex.back().first_record + blockIndex.back().num_records;
+}
+
+void ColumnarTraceReader::readBlock(size_t block, std::vector<RawMemTrace>& records) {
+    const BlockIndexEntry& entry = blockIndex.at(block);
+    uint8_t sizes[8];
+    readBytes(entry.offset, sizes, 8);
+    uint32_t stored_size = getU32(sizes);
+    uint32_t payload_size = getU32(sizes + 4);
+
+    payload.resize(payload_size);
+    if (compressed) {
+        stored.resize(stored_size);
+        readBytes(entry.offset + 8, stored.data(), stored_size);
+        uLongf size = payload_size;
+        if (uncompress(payload.data(), &size, stored.data(), stored_size) != Z_OK || size != payload_size) {
+            error("cannot decompress a block");
+        }
+    } else {
+        readBytes(entry.offset + 8, payload.data(), payload_size);
+    }
+
+    // split the payload into columns
+    if (payload_size < 4) {
+        error("truncated block");
+    }
+    uint32_t num_records = getU32(payload.data());
+    if (num_records != entry.num_records) {
+        error("block index does not match the block");
+    }
+    ColumnDecoder columns[NUM_COLUMNS];
+    size_t pos = 4;
+    for (int i = 0; i < NUM_COLUMNS; ++i) {
+        if (pos + 4 > payload_size) {
+            error("truncated block");
+        }
+        uint32_t column_size = getU32(&payload[pos]);
+        pos += 4;
+        if (pos + column_size > payload_size) {
+            error("truncated block");
+        }
+        columns[i].p = &payload[pos];
+        columns[i].end = &payload[pos] + column_size;
+        pos += column_size;
+    }
+    ColumnDecoder& line_addresses = columns[0];
+    ColumnDecoder& line_offsets = columns[1];
+    ColumnDecoder& bb_ids = columns[2];
+    ColumnDecoder& thread_ids = columns[3];
+    ColumnDecoder& flags = columns[4];
+    if ((size_t)(flags.end - flags.p) != num_records) {
+        error("corrupted flags column");
+    }
+
+    records.resize(num_records);
+    uint64_t line = 0;
+    int bb_id = 0;
+    uint64_t bb_id_run = 0;
+    int thread_id = 0;
+    uint64_t thread_id_run = 0;
+    for (uint32_t i = 0; i < num_records; ++i) {
+        RawMemTrace& record = records[i];
+        line += line_addresses.zigzag();
+        record.line_address = line << lineBits;
+        record.address = record.line_address + line_offsets.varint();
+        if (bb_id_run == 0) {
+            bb_id = bb_ids.zigzag();
+            bb_id_run = bb_ids.varint();
+        }
+        bb_id_run--;
+        record.bb_id = bb_id;
+        if (thread_id_run == 0) {
+            thread_id = thread_ids.zigzag();
+            thread_id_run = thread_ids.varint();
+        }
+        thread_id_run--;
+        record.thread_id = thread_id;
+        uint8_t flag = *flags.p++;
+        record.access_type = static_cast<RawAccessType>(flag & 3);
+        record.hit_status = static_cast<RawHitStatus>((flag >> 2) & 3);
+        record.data_region = (flag >> 4) & 3;
+    }
+}
+
+void ColumnarTraceReader::readBytes(uint64_t offset, void* data, size_t size) {
+    if (fseeko(file, offset, SEEK_SET) != 0 || fread(data, 1, size, file) != size) {
+        error("truncated file");
+    }
+}
+
+void ColumnarTraceReader::error(const char* msg) const {
+    std::cerr << "Error reading columnar trace " << filename << ": " << msg << std::endl;
+    exit(1);
+}
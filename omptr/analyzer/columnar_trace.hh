@@ -0,0 +1,77 @@
+// Reader of the columnar binary raw memory traces written by the CustomMemProbe
+// (format described in src/mem/ruby/system/CustomMemColumnarTrace.hh)
+
+#ifndef __COLUMNAR_TRACE_HH__
+#define __COLUMNAR_TRACE_HH__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum RawAccessType {
+    RAW_IFETCH,
+    RAW_READ,
+    RAW_WRITE
+};
+
+enum RawHitStatus {
+    RAW_LOCAL_L1_CACHE,
+    RAW_REMOTE_L1_CACHE,
+    RAW_L2_CACHE,
+    RAW_MEMORY
+};
+
+typedef struct RawMemTrace {
+    int bb_id;
+    int thread_id;
+    uint64_t address;
+    uint64_t line_address;
+    RawAccessType access_type;
+    RawHitStatus hit_status;
+    int data_region;
+} RawMemTrace;
+
+typedef struct BBExecCycles {
+    int bb_id;
+    int thread_id;
+    uint64_t exec_cycles;
+} BBExecCycles;
+
+class ColumnarTraceReader {
+public:
+    explicit ColumnarTraceReader(const std::string& filename);
+    ~ColumnarTraceReader();
+
+    size_t numBlocks() const { return blockIndex.size(); }
+    uint64_t numRecords() const;
+
+    // execution cycles of the basic blocks that ended
+    const std::vector<BBExecCycles>& bbExecCycles() const { return bbMetadata; }
+
+    // decode the records of a block, blocks are independent and can be read in any order
+    void readBlock(size_t block, std::vector<RawMemTrace>& records);
+
+private:
+    struct BlockIndexEntry {
+        uint64_t offset;
+        uint64_t first_record;
+        uint32_t num_records;
+    };
+
+    FILE* file;
+    std::string filename;
+    int lineBits;
+    bool compressed;
+    std::vector<BlockIndexEntry> blockIndex;
+    std::vector<BBExecCycles> bbMetadata;
+
+    // scratch buffers, kept to avoid allocations per block
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> payload;
+
+    void readBytes(uint64_t offset, void* data, size_t size);
+    [[noreturn]] void error(const char* msg) const;
+};
+
+#endif
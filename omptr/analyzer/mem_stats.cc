@@ -0,0 +1,405 @@
+#include "mem_stats.hh"
+#include "proto/custom_mem_trace.pb.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// the ASCII characters gem5, written at the beginning of every proto stream
+const uint32_t PROTO_MAGIC = 0x356d6567;
+const size_t CHUNK_SIZE = 4 << 20;
+
+const char CACHE_MAGIC[] = "OMPTRMS1";
+
+// header of the cache file, followed by the bb offsets, the execution cycles, the metadata flags
+// (padded to 8 bytes) and the records, all in the native byte order
+typedef struct CacheHeader {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t num_bbs;
+    uint64_t num_records;
+    uint64_t padding;
+} CacheHeader;
+
+size_t align8(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+// decode a varint from [p, end), false if it is truncated
+bool read_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// parse a chunk of size-prefixed messages
+void parse_chunk(const std::vector<uint8_t>& chunk, std::vector<AddrAccessStats>& stats,
+                 std::vector<std::pair<int, uint64_t>>& metadata) {
+    ProtoMessage::AddrAccessStats msg;
+    const uint8_t* p = chunk.data();
+    const uint8_t* end = p + chunk.size();
+    while (p != end) {
+        uint64_t size;
+        if (!read_varint(p, end, size) || size > (uint64_t)(end - p) || !msg.ParseFromArray(p, size)) {
+            std::cerr << "Corrupted message in the mem stats file" << std::endl;
+            exit(1);
+        }
+        p += size;
+
+        assert(msg.bb_id() >= 0);
+        if (msg.is_metadata()) {
+            metadata.push_back(std::make_pair(msg.bb_id(), msg.exec_cycles()));
+            continue;
+        }
+        AddrAccessStats entry;
+        entry.line_address = msg.line_address();
+        entry.num_local_l1_hit = msg.num_local_l1_hit();
+        entry.num_remote_l1_hit = msg.num_remote_l1_hit();
+        entry.num_l2_hit = msg.num_l2_hit();
+        entry.num_memory_access = msg.num_memory_access();
+        entry.bb_id = msg.bb_id();
+        entry.thread_id = msg.thread_id();
+        entry.data_region = static_cast<DataRegion>(msg.data_region());
+        entry.is_ifetch = msg.is_ifetch();
+        entry.is_shared = false;  // to be populated later based on the DAG structure
+        stats.push_back(entry);
+    }
+}
+
+}  // namespace
+
+std::string mem_stats_cache_file(const std::string& filename) {
+    return filename + ".flat";
+}
+
+AddrAccessStats* BBStats::find(Addr line_address) const {
+    AddrAccessStats* it = std::lower_bound(first, last, line_address,
+        [](const AddrAccessStats& stats, Addr line_address) { return stats.line_address < line_address; });
+    if (it != last && it->line_address == line_address) {
+        return it;
+    }
+    return last;
+}
+
+MemStats::MemStats() : records(NULL), numRecords(0), mapping(NULL), mappingSize(0) {
+}
+
+MemStats::~MemStats() {
+    release();
+}
+
+void MemStats::release() {
+    if (mapping != NULL) {
+        munmap(mapping, mappingSize);
+        mapping = NULL;
+        mappingSize = 0;
+    }
+    std::vector<AddrAccessStats>().swap(ownedRecords);
+    records = NULL;
+    numRecords = 0;
+    bbOffset.clear();
+    bbExecCycles.clear();
+    bbHasMetadata.clear();
+}
+
+bool MemStats::allBBsEnded() const {
+    return std::find(bbHasMetadata.begin(), bbHasMetadata.end(), 0) == bbHasMetadata.end();
+}
+
+void MemStats::build(std::vector<AddrAccessStats>&& stats, std::vector<uint64_t>&& exec_cycles,
+                     std::vector<uint8_t>&& has_metadata) {
+    release();
+    size_t num_bbs = std::max(exec_cycles.size(), has_metadata.size());
+    for (const AddrAccessStats& entry : stats) {
+        assert(entry.bb_id >= 0);
+        num_bbs = std::max(num_bbs, (size_t)entry.bb_id + 1);
+    }
+
+    // counting sort by basic block, then sort every span by line
+    bbOffset.assign(num_bbs + 1, 0);
+    for (const AddrAccessStats& entry : stats) {
+        bbOffset[entry.bb_id + 1]++;
+    }
+    for (size_t bb = 0; bb < num_bbs; ++bb) {
+        bbOffset[bb + 1] += bbOffset[bb];
+    }
+    ownedRecords.resize(stats.size());
+    std::vector<uint64_t> fill(bbOffset.begin(), bbOffset.end() - 1);
+    for (const AddrAccessStats& entry : stats) {
+        ownedRecords[fill[entry.bb_id]++] = entry;
+    }
+    std::vector<AddrAccessStats>().swap(stats);
+
+    // merge the stats of the same line
+    size_t num_records = 0;
+    for (size_t bb = 0; bb < num_bbs; ++bb) {
+        AddrAccessStats* first = ownedRecords.data() + bbOffset[bb];
+        AddrAccessStats* last = ownedRecords.data() + bbOffset[bb + 1];
+        std::sort(first, last, [](const AddrAccessStats& a, const AddrAccessStats& b) {
+            return a.line_address < b.line_address;
+        });
+        bbOffset[bb] = num_records;
+        for (AddrAccessStats* it = first; it != last; ++it) {
+            if (num_records != bbOffset[bb] && ownedRecords[num_records - 1].line_address == it->line_address) {
+                AddrAccessStats& merged = ownedRecords[num_records - 1];
+                merged.num_local_l1_hit += it->num_local_l1_hit;
+                merged.num_remote_l1_hit += it->num_remote_l1_hit;
+                merged.num_l2_hit += it->num_l2_hit;
+                merged.num_memory_access += it->num_memory_access;
+            } else {
+                ownedRecords[num_records++] = *it;
+            }
+        }
+    }
+    bbOffset[num_bbs] = num_records;
+    ownedRecords.resize(num_records);
+    ownedRecords.shrink_to_fit();
+    records = ownedRecords.data();
+    numRecords = num_records;
+
+    bbExecCycles = std::move(exec_cycles);
+    bbExecCycles.resize(num_bbs, 0);
+    bbHasMetadata = std::move(has_metadata);
+    bbHasMetadata.resize(num_bbs, 0);
+}
+
+void MemStats::parse(const std::string& filename, unsigned num_threads) {
+    printf("Parsing memory stats from %s...\n", filename.c_str());
+    // gzread also reads uncompressed files
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (file == NULL) {
+        printf("[Error] Unable to open file %s.\n", filename.c_str());
+        exit(1);
+    }
+    gzbuffer(file, 1 << 20);
+    uint8_t magic[4];
+    if (gzread(file, magic, 4) != 4 ||
+        (uint32_t)(magic[0] | magic[1] << 8 | magic[2] << 16 | (uint32_t)magic[3] << 24) != PROTO_MAGIC) {
+        printf("[Error] %s is not a proto stream.\n", filename.c_str());
+        exit(1);
+    }
+
+    // bounded queue of chunks between the decompressing thread and the parsing threads
+    num_threads = std::max(num_threads, 1u);
+    const size_t max_queued_chunks = 2 * num_threads;
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<std::vector<uint8_t>> queue;
+    bool finished = false;
+
+    std::vector<std::vector<AddrAccessStats>> thread_stats(num_threads);
+    std::vector<std::vector<std::pair<int, uint64_t>>> thread_metadata(num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<uint8_t> chunk;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    not_empty.wait(lock, [&]() { return !queue.empty() || finished; });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    chunk.swap(queue.front());
+                    queue.pop_front();
+                }
+                not_full.notify_one();
+                parse_chunk(chunk, thread_stats[t], thread_metadata[t]);
+            }
+        });
+    }
+
+    // split the decompressed stream at message boundaries
+    std::vector<uint8_t> buffer;
+    size_t buffer_size = 0;
+    while (true) {
+        buffer.resize(buffer_size + CHUNK_SIZE);
+        int read = gzread(file, &buffer[buffer_size], CHUNK_SIZE);
+        if (read < 0) {
+            printf("[Error] Unable to decompress %s.\n", filename.c_str());
+            exit(1);
+        }
+        buffer_size += read;
+        const uint8_t* p = buffer.data();
+        const uint8_t* end = p + buffer_size;
+        const uint8_t* complete = p;
+        uint64_t size;
+        while (read_varint(p, end, size) && size <= (uint64_t)(end - p)) {
+            p += size;
+            complete = p;
+        }
+        size_t chunk_size = complete - buffer.data();
+        if (read == 0 && chunk_size != buffer_size) {
+            printf("[Error] Truncated message at the end of %s.\n", filename.c_str());
+            exit(1);
+        }
+        if (chunk_size != 0) {
+            std::vector<uint8_t> rest(buffer.begin() + chunk_size, buffer.begin() + buffer_size);
+            buffer.resize(chunk_size);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                not_full.wait(lock, [&]() { return queue.size() < max_queued_chunks; });
+                queue.push_back(std::move(buffer));
+            }
+            not_empty.notify_one();
+            buffer = std::move(rest);
+            buffer_size = buffer.size();
+        }
+        if (read == 0) {
+            break;
+        }
+    }
+    gzclose(file);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    not_empty.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<AddrAccessStats> stats;
+    std::vector<uint64_t> exec_cycles;
+    std::vector<uint8_t> has_metadata;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        stats.insert(stats.end(), thread_stats[t].begin(), thread_stats[t].end());
+        std::vector<AddrAccessStats>().swap(thread_stats[t]);
+        for (const std::pair<int, uint64_t>& metadata : thread_metadata[t]) {
+            size_t bb_id = metadata.first;
+            if (bb_id >= exec_cycles.size()) {
+                exec_cycles.resize(bb_id + 1, 0);
+                has_metadata.resize(bb_id + 1, 0);
+            }
+            assert(!has_metadata[bb_id]);
+            exec_cycles[bb_id] = metadata.second;
+            has_metadata[bb_id] = 1;
+        }
+    }
+    build(std::move(stats), std::move(exec_cycles), std::move(has_metadata));
+    printf("Done\n");
+}
+
+bool MemStats::loadCache(const std::string& filename) {
+    std::string cache_filename = mem_stats_cache_file(filename);
+    struct stat source;
+    if (stat(filename.c_str(), &source) != 0) {
+        return false;
+    }
+    int fd = open(cache_filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat cache;
+    if (fstat(fd, &cache) != 0 || (size_t)cache.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return false;
+    }
+    // private mapping: the shared status written by the analysis is not written back
+    void* data = mmap(NULL, cache.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    const CacheHeader* header = static_cast<const CacheHeader*>(data);
+    size_t num_bbs = header->num_bbs;
+    size_t offsets_size = (num_bbs + 1) * sizeof(uint64_t);
+    size_t exec_cycles_size = num_bbs * sizeof(uint64_t);
+    size_t has_metadata_size = align8(num_bbs);
+    bool valid = memcmp(header->magic, CACHE_MAGIC, 8) == 0 &&
+                 header->record_size == sizeof(AddrAccessStats) &&
+                 header->source_size == (uint64_t)source.st_size &&
+                 header->source_mtime_sec == (int64_t)source.st_mtim.tv_sec &&
+                 header->source_mtime_nsec == (int64_t)source.st_mtim.tv_nsec &&
+                 (size_t)cache.st_size == sizeof(CacheHeader) + offsets_size + exec_cycles_size +
+                     has_metadata_size + header->num_records * sizeof(AddrAccessStats);
+    if (!valid) {
+        munmap(data, cache.st_size);
+        return false;
+    }
+
+    printf("Loading memory stats from %s...\n", cache_filename.c_str());
+    release();
+    mapping = data;
+    mappingSize = cache.st_size;
+    const uint8_t* p = static_cast<const uint8_t*>(data) + sizeof(CacheHeader);
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(p);
+    bbOffset.assign(offsets, offsets + num_bbs + 1);
+    p += offsets_size;
+    const uint64_t* exec_cycles = reinterpret_cast<const uint64_t*>(p);
+    bbExecCycles.assign(exec_cycles, exec_cycles + num_bbs);
+    p += exec_cycles_size;
+    bbHasMetadata.assign(p, p + num_bbs);
+    p += has_metadata_size;
+    records = reinterpret_cast<AddrAccessStats*>(const_cast<uint8_t*>(p));
+    numRecords = header->num_records;
+    printf("Done\n");
+    return true;
+}
+
+void MemStats::saveCache(const std::string& filename) const {
+    std::string cache_filename = mem_stats_cache_file(filename);
+    std::string tmp_filename = cache_filename + ".tmp";
+    struct stat source;
+    FILE* file = NULL;
+    if (stat(filename.c_str(), &source) != 0 || (file = fopen(tmp_filename.c_str(), "wb")) == NULL) {
+        printf("[Warning] Unable to write the cache file %s.\n", cache_filename.c_str());
+        return;
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, 8);
+    header.record_size = sizeof(AddrAccessStats);
+    header.source_size = source.st_size;
+    header.source_mtime_sec = source.st_mtim.tv_sec;
+    header.source_mtime_nsec = source.st_mtim.tv_nsec;
+    header.num_bbs = size();
+    header.num_records = numRecords;
+    std::vector<uint8_t> has_metadata(bbHasMetadata);
+    has_metadata.resize(align8(size()), 0);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(bbOffset.data(), sizeof(uint64_t), bbOffset.size(), file) == bbOffset.size() &&
+              fwrite(bbExecCycles.data(), sizeof(uint64_t), size(), file) == size() &&
+              fwrite(has_metadata.data(), 1, has_metadata.size(), file) == has_metadata.size();
+    // the shared status is computed by every run
+    std::vector<AddrAccessStats> batch;
+    for (size_t i = 0; ok && i < numRecords; i += 4096) {
+        batch.assign(records + i, records + std::min(numRecords, i + 4096));
+        for (AddrAccessStats& entry : batch) {
+            entry.is_shared = false;
+        }
+        ok = fwrite(batch.data(), sizeof(AddrAccessStats), batch.size(), file) == batch.size();
+    }
+    if (fclose(file) != 0 || !ok || rename(tmp_filename.c_str(), cache_filename.c_str()) != 0) {
+        remove(tmp_filename.c_str());
+        printf("[Warning] Unable to write the cache file %s.\n", cache_filename.c_str());
+    }
+}
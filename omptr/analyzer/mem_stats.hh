@@ -0,0 +1,108 @@
+// Memory stats of the basic blocks as a flat array
+//
+// The stats of all the basic blocks are kept in one array sorted by (bb_id, line_address), so that the
+// stats of a basic block are a contiguous span. The array can be saved to a cache file next to the
+// mem stats file and memory-mapped by later runs, which then skip parsing entirely.
+
+#ifndef __MEM_STATS_HH__
+#define __MEM_STATS_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef uint64_t Addr;
+typedef int Tid;
+
+enum DataRegion {
+    GLOBAL,
+    STACK,
+    HEAP
+};
+
+typedef struct AddrAccessStats {
+    Addr line_address;
+    uint64_t num_local_l1_hit;
+    uint64_t num_remote_l1_hit;
+    uint64_t num_l2_hit;
+    uint64_t num_memory_access;
+    int bb_id;
+    Tid thread_id;
+    DataRegion data_region;
+    bool is_ifetch;
+    bool is_shared;
+} AddrAccessStats;
+
+// stats of the lines accessed by a basic block, sorted by line address
+class BBStats {
+public:
+    BBStats(AddrAccessStats* first, AddrAccessStats* last) : first(first), last(last) {}
+
+    AddrAccessStats* begin() const { return first; }
+    AddrAccessStats* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+
+    // stats of a line, end() if the line is not accessed
+    AddrAccessStats* find(Addr line_address) const;
+
+private:
+    AddrAccessStats* first;
+    AddrAccessStats* last;
+};
+
+class MemStats {
+public:
+    MemStats();
+    ~MemStats();
+
+    // number of basic blocks
+    size_t size() const { return bbOffset.empty() ? 0 : bbOffset.size() - 1; }
+    bool empty() const { return numRecords == 0; }
+
+    BBStats operator[](size_t bb_id) { return BBStats(records + bbOffset[bb_id], records + bbOffset[bb_id + 1]); }
+    const BBStats operator[](size_t bb_id) const {
+        return BBStats(records + bbOffset[bb_id], records + bbOffset[bb_id + 1]);
+    }
+
+    // execution cycles of the basic blocks, 0 for those without metadata
+    const std::vector<uint64_t>& execCycles() const { return bbExecCycles; }
+    // true if every basic block has its metadata, i.e. every basic block ended
+    bool allBBsEnded() const;
+
+    // build from unsorted stats, the stats of the same line in the same basic block are summed
+    void build(std::vector<AddrAccessStats>&& stats, std::vector<uint64_t>&& exec_cycles,
+               std::vector<uint8_t>&& has_metadata);
+
+    // parse a gzip'ed stream of ProtoMessage::AddrAccessStats written by the CustomMemProbe:
+    // one thread decompresses and splits the stream into chunks of messages, the others parse them
+    void parse(const std::string& filename, unsigned num_threads);
+
+    // load the cache file of a mem stats file, false if it is missing or out of date
+    bool loadCache(const std::string& filename);
+    // save the cache file of a mem stats file
+    void saveCache(const std::string& filename) const;
+
+private:
+    // stats of basic block b at [bbOffset[b], bbOffset[b + 1])
+    AddrAccessStats* records;
+    size_t numRecords;
+    std::vector<uint64_t> bbOffset;
+    std::vector<uint64_t> bbExecCycles;
+    std::vector<uint8_t> bbHasMetadata;
+
+    // storage of the records, either owned or memory-mapped from the cache file
+    std::vector<AddrAccessStats> ownedRecords;
+    void* mapping;
+    size_t mappingSize;
+
+    void release();
+
+    MemStats(const MemStats&);
+    MemStats& operator=(const MemStats&);
+};
+
+// path of the cache file of a mem stats file
+std::string mem_stats_cache_file(const std::string& filename);
+
+#endif
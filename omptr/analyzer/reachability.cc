@@ -0,0 +1,194 @@
+#include "reachability.hh"
+
+#include <boost/graph/topological_sort.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <iterator>
+#include <thread>
+
+Reachability::Reachability(const Graph& g, size_t max_bitset_bytes, unsigned num_threads)
+    : numVertices(boost::num_vertices(g)), numWords((numVertices + 63) / 64), visitEpoch(0) {
+    // copy the successors in a compact form
+    succOffset.reserve(numVertices + 1);
+    succOffset.push_back(0);
+    for (Vertex u = 0; u < numVertices; ++u) {
+        auto out_edges = boost::out_edges(u, g);
+        for (auto it = out_edges.first; it != out_edges.second; ++it) {
+            succ.push_back(boost::target(*it, g));
+        }
+        succOffset.push_back(succ.size());
+    }
+
+    // sinks first
+    std::vector<Vertex> reverse_topo_order;
+    reverse_topo_order.reserve(numVertices);
+    boost::topological_sort(g, std::back_inserter(reverse_topo_order));
+    topoRank.resize(numVertices);
+    for (size_t i = 0; i < numVertices; ++i) {
+        topoRank[reverse_topo_order[i]] = numVertices - 1 - i;
+    }
+
+    if ((double)numVertices * numWords * sizeof(uint64_t) <= (double)max_bitset_bytes) {
+        computeBitsets(reverse_topo_order, std::max(num_threads, 1u));
+    } else {
+        printf("DAG too large for reachability bitsets, using interval labelling\n");
+        computeLabels();
+    }
+}
+
+void Reachability::computeBitsets(const std::vector<Vertex>& reverse_topo_order, unsigned num_threads) {
+    bits.assign(numVertices * numWords, 0);
+
+    // group the vertices by level, the rows of a level only depend on the rows of lower levels
+    std::vector<size_t> level(numVertices, 0);
+    size_t num_levels = 0;
+    for (Vertex u : reverse_topo_order) {
+        for (size_t i = succOffset[u]; i < succOffset[u + 1]; ++i) {
+            level[u] = std::max(level[u], level[succ[i]] + 1);
+        }
+        num_levels = std::max(num_levels, level[u] + 1);
+    }
+    std::vector<size_t> level_offset(num_levels + 1, 0);
+    for (Vertex u = 0; u < numVertices; ++u) {
+        level_offset[level[u] + 1]++;
+    }
+    for (size_t l = 0; l < num_levels; ++l) {
+        level_offset[l + 1] += level_offset[l];
+    }
+    std::vector<Vertex> by_level(numVertices);
+    std::vector<size_t> fill(level_offset.begin(), level_offset.end() - 1);
+    for (Vertex u = 0; u < numVertices; ++u) {
+        by_level[fill[level[u]]++] = u;
+    }
+
+    auto compute_rows = [this, &by_level](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; ++j) {
+            Vertex u = by_level[j];
+            uint64_t* row = &bits[u * numWords];
+            for (size_t i = succOffset[u]; i < succOffset[u + 1]; ++i) {
+                Vertex v = succ[i];
+                const uint64_t* v_row = &bits[v * numWords];
+                // plain word loop, vectorized by the compiler
+                for (size_t w = 0; w < numWords; ++w) {
+                    row[w] |= v_row[w];
+                }
+                row[v / 64] |= 1ULL << (v % 64);
+            }
+        }
+    };
+
+    // only levels with enough work are worth the threads
+    const size_t min_parallel_words = 1 << 16;
+    for (size_t l = 0; l < num_levels; ++l) {
+        size_t begin = level_offset[l];
+        size_t end = level_offset[l + 1];
+        size_t num_threads_level = std::min<size_t>(num_threads, end - begin);
+        if (num_threads_level <= 1 || (end - begin) * numWords < min_parallel_words) {
+            compute_rows(begin, end);
+            continue;
+        }
+        std::vector<std::thread> threads;
+        size_t chunk = (end - begin + num_threads_level - 1) / num_threads_level;
+        for (size_t t = 0; t < num_threads_level; ++t) {
+            size_t chunk_begin = begin + t * chunk;
+            size_t chunk_end = std::min(end, chunk_begin + chunk);
+            if (chunk_begin < chunk_end) {
+                threads.emplace_back(compute_rows, chunk_begin, chunk_end);
+            }
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+void Reachability::computeLabels() {
+    labelLow.resize(NUM_LABELLINGS * numVertices);
+    labelHigh.resize(NUM_LABELLINGS * numVertices);
+    visited.assign(numVertices, 0);
+
+    std::vector<bool> has_pred(numVertices, false);
+    for (Vertex v : succ) {
+        has_pred[v] = true;
+    }
+    std::vector<Vertex> sources;
+    for (Vertex u = 0; u < numVertices; ++u) {
+        if (!has_pred[u]) {
+            sources.push_back(u);
+        }
+    }
+
+    // DFS stack entries: vertex and number of successors already visited
+    std::vector<std::pair<Vertex, size_t>> stack;
+    std::vector<bool> discovered(numVertices);
+    for (int l = 0; l < NUM_LABELLINGS; ++l) {
+        uint32_t* low = &labelLow[l * numVertices];
+        uint32_t* high = &labelHigh[l * numVertices];
+        std::fill(discovered.begin(), discovered.end(), false);
+        uint32_t rank = 0;
+        // the first labelling visits the successors in order, the others from a pseudo-random one
+        auto successor = [this, l](Vertex u, size_t k) {
+            size_t degree = succOffset[u + 1] - succOffset[u];
+            size_t start = l == 0 ? 0 : (u * 2654435761ULL + l * 40503ULL) % degree;
+            return succ[succOffset[u] + (start + k) % degree];
+        };
+        for (size_t s = 0; s < sources.size(); ++s) {
+            Vertex source = sources[l % 2 == 0 ? s : sources.size() - 1 - s];
+            discovered[source] = true;
+            stack.push_back(std::make_pair(source, 0));
+            while (!stack.empty()) {
+                Vertex u = stack.back().first;
+                size_t& k = stack.back().second;
+                if (k < succOffset[u + 1] - succOffset[u]) {
+                    Vertex v = successor(u, k++);
+                    if (!discovered[v]) {
+                        discovered[v] = true;
+                        stack.push_back(std::make_pair(v, 0));
+                    }
+                    continue;
+                }
+                // post-order: all the descendants are labelled
+                high[u] = ++rank;
+                low[u] = rank;
+                for (size_t i = succOffset[u]; i < succOffset[u + 1]; ++i) {
+                    low[u] = std::min(low[u], low[succ[i]]);
+                }
+                stack.pop_back();
+            }
+        }
+        assert(rank == numVertices);
+    }
+}
+
+bool Reachability::reachableByLabels(Vertex u, Vertex v) const {
+    if (u == v || topoRank[u] >= topoRank[v] || !labelsContain(u, v)) {
+        return false;
+    }
+
+    if (++visitEpoch == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        visitEpoch = 1;
+    }
+    dfsStack.clear();
+    dfsStack.push_back(u);
+    while (!dfsStack.empty()) {
+        Vertex x = dfsStack.back();
+        dfsStack.pop_back();
+        for (size_t i = succOffset[x]; i < succOffset[x + 1]; ++i) {
+            Vertex c = succ[i];
+            if (c == v) {
+                return true;
+            }
+            if (visited[c] == visitEpoch) {
+                continue;
+            }
+            visited[c] = visitEpoch;
+            // prune the successors that cannot reach v
+            if (topoRank[c] < topoRank[v] && labelsContain(c, v)) {
+                dfsStack.push_back(c);
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,83 @@
+// Reachability queries on the DAG of basic blocks
+//
+// For DAGs whose bitsets fit in the memory budget, the descendants of every vertex are kept as a
+// word-packed bitset, so that a query is a single bit test. The bitsets are computed level by level
+// bottom-up (the level of a vertex is the length of its longest path to a sink): the row of a vertex
+// is the OR of the rows of its successors, and the vertices of a level are processed in parallel.
+//
+// Larger DAGs fall back to interval labelling (GRAIL, Yildirim et al., VLDB 2010): every vertex gets
+// a few intervals from randomized post-order traversals such that the intervals of a descendant are
+// contained in those of its ancestors. A query whose intervals are not contained is answered
+// negatively in O(1), the others by a DFS pruned by the intervals and the topological order.
+
+#ifndef __REACHABILITY_HH__
+#define __REACHABILITY_HH__
+
+#include <boost/graph/adjacency_list.hpp>
+#include <cstdint>
+#include <vector>
+
+class Reachability {
+public:
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> Graph;
+    typedef boost::graph_traits<Graph>::vertex_descriptor Vertex;
+
+    // max_bitset_bytes: memory budget of the bitsets, the interval labelling is used beyond it
+    // num_threads: number of threads computing the bitsets
+    Reachability(const Graph& g, size_t max_bitset_bytes, unsigned num_threads);
+
+    // true if there is a path from u to v (u != v), not thread safe with the interval labelling
+    bool reachable(Vertex u, Vertex v) const {
+        if (!bits.empty()) {
+            return (bits[u * numWords + v / 64] >> (v % 64)) & 1;
+        }
+        return reachableByLabels(u, v);
+    }
+
+    // true if neither u nor v reaches the other, i.e. the basic blocks may execute in parallel
+    bool parallel(Vertex u, Vertex v) const {
+        return u != v && !reachable(u, v) && !reachable(v, u);
+    }
+
+    bool usesBitsets() const { return !bits.empty(); }
+
+private:
+    static const int NUM_LABELLINGS = 4;
+
+    size_t numVertices;
+    size_t numWords;
+    // descendants of vertex u at [u * numWords, (u + 1) * numWords)
+    std::vector<uint64_t> bits;
+
+    // successors of vertex u at [succOffset[u], succOffset[u + 1]) (CSR)
+    std::vector<size_t> succOffset;
+    std::vector<Vertex> succ;
+    // position of each vertex in a topological order
+    std::vector<size_t> topoRank;
+    // interval [labelLow, labelHigh] of vertex u in labelling i at [i * numVertices + u]
+    std::vector<uint32_t> labelLow;
+    std::vector<uint32_t> labelHigh;
+    // DFS state of the queries
+    mutable std::vector<uint32_t> visited;
+    mutable uint32_t visitEpoch;
+    mutable std::vector<Vertex> dfsStack;
+
+    void computeBitsets(const std::vector<Vertex>& reverse_topo_order, unsigned num_threads);
+    void computeLabels();
+
+    // true if the intervals of v are contained in those of u in every labelling
+    bool labelsContain(Vertex u, Vertex v) const {
+        for (int i = 0; i < NUM_LABELLINGS; ++i) {
+            size_t iu = i * numVertices + u;
+            size_t iv = i * numVertices + v;
+            if (labelLow[iv] < labelLow[iu] || labelHigh[iv] > labelHigh[iu]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool reachableByLabels(Vertex u, Vertex v) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+# This is the helper script to write a mem stats file from a readable table, for the analyzer tests.
+# The mem stats file is the gzip'ed stream of ProtoMessage::AddrAccessStats written by the CustomMemProbe
+# (see proto/custom_mem_trace.proto). The messages are encoded by hand so that no protobuf module is needed.
+# Usage:
+#     python3 mem_stats_from_csv.py <mem stats csv> <output mem stats file>
+
+import gzip
+import struct
+import sys
+
+# ASCII characters gem5, magic number of the gem5 proto streams
+PROTO_MAGIC = 0x356d6567
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def addr_access_stats(bb_id, thread_id, line_address, is_ifetch, counters, is_metadata, exec_cycles):
+    # (field number, value) of the fields of ProtoMessage::AddrAccessStats, all varints
+    fields = [
+        (1, bb_id),
+        (2, line_address),
+        (3, line_address),
+        (4, is_ifetch),
+        (5, counters[0]),
+        (6, counters[1]),
+        (7, counters[2]),
+        (8, counters[3]),
+        (9, thread_id),
+        (10, 0),  # GLOBAL data region
+        (11, is_metadata),
+        (12, exec_cycles),
+    ]
+    return b"".join(varint(number << 3) + varint(value) for number, value in fields)
+
+
+def convert(csv_file, output_file):
+    messages = []
+    with open(csv_file) as fp:
+        for line in fp:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            fields = line.split(',')
+            bb_id, thread_id = int(fields[0]), int(fields[1])
+            if fields[2] == "exec":
+                messages.append(addr_access_stats(bb_id, thread_id, 0, 0, [0, 0, 0, 0], 1, int(fields[3])))
+            else:
+                counters = [int(field) for field in fields[4:8]]
+                messages.append(addr_access_stats(bb_id, thread_id, int(fields[2], 16), int(fields[3]),
+                                                  counters, 0, 0))
+
+    with gzip.open(output_file, 'wb') as fp:
+        fp.write(struct.pack('<I', PROTO_MAGIC))
+        for message in messages:
+            fp.write(varint(len(message)) + message)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print(f"Usage: {sys.argv[0]} <mem stats csv> <output mem stats file>")
+        sys.exit(1)
+    convert(sys.argv[1], sys.argv[2])
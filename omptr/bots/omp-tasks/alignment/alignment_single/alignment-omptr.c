@@ -514,7 +514,7 @@ int pairalign()
    } // end single
    } // end parallel
    bots_message(" completed!\n");
-   OMPTR_PRINT("alignment.json");
+   OMPTR_PRINT("alignment.dag");
    return 0;
 }
 
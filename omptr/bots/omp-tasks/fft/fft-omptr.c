@@ -5143,7 +5143,7 @@ void fft(int n, COMPLEX * in, COMPLEX * out)
      bots_message(" completed!\n");
 
      free(W);
-	 OMPTR_PRINT("fft.json");
+	 OMPTR_PRINT("fft.dag");
      return;
 }
 void fft_seq(int n, COMPLEX * in, COMPLEX * out)
@@ -669,6 +669,6 @@ void sim_village_main_par(struct Village *top)
    OMPTR_TASK_END();
 }  // end single
 }  // end parallel 
-   OMPTR_PRINT("health.json");
+   OMPTR_PRINT("health.dag");
 }
 
@@ -422,7 +422,7 @@ void find_queens (int size)
 #endif
 	}
 	bots_message(" completed!\n");
-	OMPTR_PRINT("nqueens.json");
+	OMPTR_PRINT("nqueens.dag");
 }
 
 
@@ -552,7 +552,7 @@ void sort_par ( void )
           OMPTR_TASK_END();
      }
 	bots_message(" completed!\n");
-     OMPTR_PRINT("sort.json");
+     OMPTR_PRINT("sort.dag");
 }
 
 int sort_verify ( void )
@@ -280,7 +280,7 @@ void sparselu_par_call(float **BENCH)
 }  // single end
 }  // parallel end
    bots_message(" completed!\n");
-   OMPTR_PRINT("sparselu.json");
+   OMPTR_PRINT("sparselu.dag");
 }
 
 
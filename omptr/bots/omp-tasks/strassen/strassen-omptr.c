@@ -1373,7 +1373,7 @@ void strassen_main_par(REAL *A, REAL *B, REAL *C, int n)
   }  // end single
   }  // end parallel
 	bots_message(" completed!\n");
-  OMPTR_PRINT("strassen.json");
+  OMPTR_PRINT("strassen.dag");
 }
 void strassen_main_seq(REAL *A, REAL *B, REAL *C, int n)
 {
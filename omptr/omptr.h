@@ -1,12 +1,20 @@
 #ifndef __OMPTR_H__
 #define __OMPTR_H__
 
-#define MAX_NUM_BB 10000
-#define MAX_NUM_TASK 10000
-#define MAX_TASK_CHILDREN 10000
-
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Records of basic blocks and tasks are indexed by ID in chunked tables: a chunk of
+// OMPTR_CHUNK_SIZE records is allocated on first use and published with a CAS, so that
+// IDs never move and no lock is taken. The directory covers every non-negative int ID.
+#define OMPTR_CHUNK_BITS 16
+#define OMPTR_CHUNK_SIZE (1 << OMPTR_CHUNK_BITS)
+#define OMPTR_NUM_CHUNKS (1 << (31 - OMPTR_CHUNK_BITS))
+
+// Variable-length waitFor lists are bump-allocated from per-thread arenas of at least this size
+#define OMPTR_ARENA_CHUNK_SIZE (1 << 20)
 
 // structs
 struct BasicBlock {
@@ -14,51 +22,220 @@ struct BasicBlock {
      int nodeID;                        // ID of corresponding task node
      int taskCreated;                   // ID of task this basic block creates
      int numTasksWaitingFor;            // Number of tasks this basic block waits for
-     int waitFor[MAX_TASK_CHILDREN];    // ID of tasks this basic block waits for
+     int *waitFor;                      // ID of tasks this basic block waits for (in an arena)
 };
 
 typedef struct BasicBlock BasicBlock;
 
+// Only modified by the task itself (when creating children and at taskwait), hence no lock
 struct OmptrTask {
      int numChildren;
-     int children[MAX_TASK_CHILDREN];
+     int capacity;
+     int *children;
 };
 
 typedef struct OmptrTask OmptrTask;
 
+struct OmptrArenaChunk {
+     struct OmptrArenaChunk *next;      // list of all the chunks, to free them
+     size_t size;
+     size_t used;
+};
+
+typedef struct OmptrArenaChunk OmptrArenaChunk;
+
 // global vars
-BasicBlock *BBs;
-OmptrTask *Tasks;
+BasicBlock **BB_Chunks;
+OmptrTask **Task_Chunks;
+OmptrArenaChunk *Arena_Chunks;
 int Task_Counter;
 int BB_Counter;
+static __thread OmptrArenaChunk *omptr_arena;
 
-// functions
-int omptr_init() {
-     Task_Counter = 0;
-     BB_Counter = 0;
+// Basic block markers
+// By default, the markers are printed and the simulator parses the write syscalls.
+// With OMPTR_USE_M5OPS defined, the markers are m5 pseudo-instructions instead
+// (opcodes from include/gem5/asm/generic/m5ops.h), which costs neither a printf nor a syscall.
+#ifdef OMPTR_USE_M5OPS
+
+#if defined(__x86_64__)
+static inline void omptr_m5op_bb_start(uint64_t bb_id) {
+     __asm__ __volatile__(".byte 0x0F, 0x04\n\t.word 0x5d" : : "D"(bb_id) : "rax", "memory");
+}
 
-     BBs = NULL;
-     Tasks = NULL;
-     BBs = (BasicBlock*)malloc(MAX_NUM_BB * sizeof(BasicBlock));
-     if (BBs == NULL) {
+static inline void omptr_m5op_bb_end(void) {
+     __asm__ __volatile__(".byte 0x0F, 0x04\n\t.word 0x5e" : : : "rax", "memory");
+}
+
+static inline void omptr_m5op_par_move_ways(uint64_t src, uint64_t dst, uint64_t num_ways) {
+     __asm__ __volatile__(".byte 0x0F, 0x04\n\t.word 0x5c"
+                          : : "D"(src), "S"(dst), "d"(num_ways) : "rax", "memory");
+}
+
+static inline void omptr_m5op_fork(uint64_t bb_id, uint64_t child_bb_id, uint64_t next_bb_id) {
+     __asm__ __volatile__(".byte 0x0F, 0x04\n\t.word 0x5f"
+                          : : "D"(bb_id), "S"(child_bb_id), "d"(next_bb_id) : "rax", "memory");
+}
+
+static inline void omptr_m5op_join(uint64_t bb_id, uint64_t next_bb_id) {
+     __asm__ __volatile__(".byte 0x0F, 0x04\n\t.word 0x60" : : "D"(bb_id), "S"(next_bb_id) : "rax", "memory");
+}
+#elif defined(__aarch64__)
+static inline void omptr_m5op_bb_start(uint64_t bb_id) {
+     register uint64_t x0 __asm__("x0") = bb_id;
+     __asm__ __volatile__(".long 0xff5d0110" : "+r"(x0) : : "memory");
+}
+
+static inline void omptr_m5op_bb_end(void) {
+     register uint64_t x0 __asm__("x0");
+     __asm__ __volatile__(".long 0xff5e0110" : "=r"(x0) : : "memory");
+}
+
+static inline void omptr_m5op_par_move_ways(uint64_t src, uint64_t dst, uint64_t num_ways) {
+     register uint64_t x0 __asm__("x0") = src;
+     register uint64_t x1 __asm__("x1") = dst;
+     register uint64_t x2 __asm__("x2") = num_ways;
+     __asm__ __volatile__(".long 0xff5c0110" : "+r"(x0) : "r"(x1), "r"(x2) : "memory");
+}
+
+static inline void omptr_m5op_fork(uint64_t bb_id, uint64_t child_bb_id, uint64_t next_bb_id) {
+     register uint64_t x0 __asm__("x0") = bb_id;
+     register uint64_t x1 __asm__("x1") = child_bb_id;
+     register uint64_t x2 __asm__("x2") = next_bb_id;
+     __asm__ __volatile__(".long 0xff5f0110" : "+r"(x0) : "r"(x1), "r"(x2) : "memory");
+}
+
+static inline void omptr_m5op_join(uint64_t bb_id, uint64_t next_bb_id) {
+     register uint64_t x0 __asm__("x0") = bb_id;
+     register uint64_t x1 __asm__("x1") = next_bb_id;
+     __asm__ __volatile__(".long 0xff600110" : "+r"(x0) : "r"(x1) : "memory");
+}
+#else
+#error "OMPTR_USE_M5OPS is only supported on x86-64 and AArch64"
+#endif
+
+#define OMPTR_BB_STARTS(bb_id) omptr_m5op_bb_start(bb_id);
+#define OMPTR_BB_ENDS(bb_id) omptr_m5op_bb_end();
+#define OMPTR_PAR(src, dst, num_ways) omptr_m5op_par_move_ways(src, dst, num_ways);
+#define OMPTR_FORK_MARKER(bb_id, child_bb_id, next_bb_id) omptr_m5op_fork(bb_id, child_bb_id, next_bb_id);
+#define OMPTR_JOIN_MARKER(bb_id, next_bb_id) omptr_m5op_join(bb_id, next_bb_id);
+
+#else
+
+#define OMPTR_BB_STARTS(bb_id) printf("[OMPTR] BB %d starts.\n", bb_id);
+#define OMPTR_BB_ENDS(bb_id) printf("[OMPTR] BB %d ends.\n", bb_id);
+#define OMPTR_PAR(src, dst, num_ways) \
+     printf("[OMPTR] PAR %d %d %d\n", (int)(src), (int)(dst), (int)(num_ways));
+#define OMPTR_FORK_MARKER(bb_id, child_bb_id, next_bb_id) \
+     printf("[OMPTR] FORK %d %d %d\n", bb_id, child_bb_id, next_bb_id);
+#define OMPTR_JOIN_MARKER(bb_id, next_bb_id) printf("[OMPTR] JOIN %d %d\n", bb_id, next_bb_id);
+
+#endif
+
+// DAG markers, for the online classification of the simulator: a basic block creates a task
+// (FORK: the first basic block of the child task, the next basic block of the current task),
+// or is followed by a taskwait (JOIN: the next basic block of the current task).
+// They are only emitted with OMPTR_ONLINE defined, so that the offline flow is not perturbed.
+#ifdef OMPTR_ONLINE
+#define OMPTR_FORK(bb_id, child_bb_id, next_bb_id) OMPTR_FORK_MARKER(bb_id, child_bb_id, next_bb_id)
+#define OMPTR_JOIN(bb_id, next_bb_id) OMPTR_JOIN_MARKER(bb_id, next_bb_id)
+#else
+#define OMPTR_FORK(bb_id, child_bb_id, next_bb_id)
+#define OMPTR_JOIN(bb_id, next_bb_id)
+#endif
+
+// functions
+static void *omptr_alloc(size_t size) {
+     void *ptr = malloc(size);
+     if (ptr == NULL) {
           printf("OMPTR ERROR: not enough memory!\n");
+          exit(-1);
      }
-     Tasks = (OmptrTask*)malloc(MAX_NUM_TASK * sizeof(OmptrTask));
-     if (Tasks == NULL) {
-          printf("OMPTR ERROR: not enough memory!\n");
+     return ptr;
+}
+
+static int omptr_next_id(int *counter) {
+     int id = __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED);
+     if (id < 0) {
+          printf("OMPTR ERROR: too many IDs!\n");
+          exit(-1);
+     }
+     return id;
+}
+
+static BasicBlock *omptr_bb(int bb_id) {
+     BasicBlock **slot = &BB_Chunks[bb_id >> OMPTR_CHUNK_BITS];
+     BasicBlock *chunk = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+     if (chunk == NULL) {
+          BasicBlock *new_chunk = (BasicBlock*)omptr_alloc(OMPTR_CHUNK_SIZE * sizeof(BasicBlock));
+          for (int i = 0; i < OMPTR_CHUNK_SIZE; ++i) {
+               new_chunk[i].taskID = 0;
+               new_chunk[i].nodeID = 0;
+               new_chunk[i].taskCreated = -1;
+               new_chunk[i].numTasksWaitingFor = 0;
+               new_chunk[i].waitFor = NULL;
+          }
+          if (__atomic_compare_exchange_n(slot, &chunk, new_chunk, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+               chunk = new_chunk;
+          } else {
+               free(new_chunk);  // another thread published the chunk first
+          }
+     }
+     return &chunk[bb_id & (OMPTR_CHUNK_SIZE - 1)];
+}
+
+static OmptrTask *omptr_task_record(int task_id) {
+     OmptrTask **slot = &Task_Chunks[task_id >> OMPTR_CHUNK_BITS];
+     OmptrTask *chunk = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+     if (chunk == NULL) {
+          OmptrTask *new_chunk = (OmptrTask*)calloc(OMPTR_CHUNK_SIZE, sizeof(OmptrTask));
+          if (new_chunk == NULL) {
+               printf("OMPTR ERROR: not enough memory!\n");
+               exit(-1);
+          }
+          if (__atomic_compare_exchange_n(slot, &chunk, new_chunk, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+               chunk = new_chunk;
+          } else {
+               free(new_chunk);  // another thread published the chunk first
+          }
      }
+     return &chunk[task_id & (OMPTR_CHUNK_SIZE - 1)];
+}
 
-     for (int i = 0; i < MAX_NUM_BB; ++i) {
-          BBs[i].taskID = 0;
-          BBs[i].nodeID = 0;
-          BBs[i].taskCreated = -1;
-          BBs[i].numTasksWaitingFor = 0;
+static int *omptr_arena_alloc(int num_ints) {
+     size_t size = num_ints * sizeof(int);
+     OmptrArenaChunk *chunk = omptr_arena;
+     if (chunk == NULL || chunk->size - chunk->used < size) {
+          size_t chunk_size = size > OMPTR_ARENA_CHUNK_SIZE ? size : OMPTR_ARENA_CHUNK_SIZE;
+          chunk = (OmptrArenaChunk*)omptr_alloc(sizeof(OmptrArenaChunk) + chunk_size);
+          chunk->size = chunk_size;
+          chunk->used = 0;
+          chunk->next = __atomic_load_n(&Arena_Chunks, __ATOMIC_RELAXED);
+          while (!__atomic_compare_exchange_n(&Arena_Chunks, &chunk->next, chunk, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+          }
+          omptr_arena = chunk;
      }
+     int *ptr = (int*)((char*)(chunk + 1) + chunk->used);
+     chunk->used += size;
+     return ptr;
+}
+
+int omptr_init() {
+     Task_Counter = 0;
+     BB_Counter = 0;
 
-     for (int i = 0; i < MAX_NUM_TASK; ++i) {
-          Tasks[i].numChildren = 0;
+     Arena_Chunks = NULL;
+     BB_Chunks = (BasicBlock**)calloc(OMPTR_NUM_CHUNKS, sizeof(BasicBlock*));
+     Task_Chunks = (OmptrTask**)calloc(OMPTR_NUM_CHUNKS, sizeof(OmptrTask*));
+     if (BB_Chunks == NULL || Task_Chunks == NULL) {
+          printf("OMPTR ERROR: not enough memory!\n");
+          exit(-1);
      }
 
+     // basic block 0 of task 0
+     omptr_bb(0);
+     omptr_task_record(0);
+
      return 0;
 }
 
@@ -70,39 +247,21 @@ int omptr_init() {
  * The new bb_id of the parent task is returned as a copy instead.
  */
 int omptr_task(int *bb_id_ptr) {
-     BasicBlock *bb = &BBs[*bb_id_ptr];
-     OmptrTask *task = &Tasks[bb->taskID];
-
-     int new_task_id;
-     int new_task_bb_id;
-     int new_bb_id;
+     BasicBlock *bb = omptr_bb(*bb_id_ptr);
+     OmptrTask *task = omptr_task_record(bb->taskID);
 
      // create child task
-     #pragma omp atomic capture
-     new_task_id = ++Task_Counter;
-
-     if (new_task_id >= MAX_NUM_TASK) {
-         printf("OMPTR ERROR: maximum number of tasks exceeds!\n");
-         exit(-1); 
-     }
-     OmptrTask *new_task = &Tasks[new_task_id];
+     int new_task_id = omptr_next_id(&Task_Counter);
+     omptr_task_record(new_task_id);
 
      // create bb for child task
-     #pragma omp atomic capture
-     new_task_bb_id = ++BB_Counter;
-
-     BasicBlock *new_task_bb = &BBs[new_task_bb_id];
+     int new_task_bb_id = omptr_next_id(&BB_Counter);
+     BasicBlock *new_task_bb = omptr_bb(new_task_bb_id);
      new_task_bb->taskID = new_task_id;
      
      // create new bb for current task
-     #pragma omp atomic capture
-     new_bb_id = ++BB_Counter;
-
-     if (new_bb_id >= MAX_NUM_BB) {
-          printf("OMPTR ERROR: maximum number of basic blocks exceeds!\n");
-          exit(-1); 
-     }
-     BasicBlock *new_bb = &BBs[new_bb_id];
+     int new_bb_id = omptr_next_id(&BB_Counter);
+     BasicBlock *new_bb = omptr_bb(new_bb_id);
      new_bb->taskID = bb->taskID;
      new_bb->nodeID = bb->nodeID + 1;
 
@@ -110,11 +269,17 @@ int omptr_task(int *bb_id_ptr) {
      bb->taskCreated = new_task_id;
 
      // record children for current task
-     task->children[task->numChildren++] = new_task_id;
-     if (task->numChildren > MAX_TASK_CHILDREN) {
-          printf("OMPTR ERROR: maximum number of task children exceeds!\n");
-          exit(-1); 
+     if (task->numChildren == task->capacity) {
+          task->capacity = task->capacity == 0 ? 16 : 2 * task->capacity;
+          task->children = (int*)realloc(task->children, task->capacity * sizeof(int));
+          if (task->children == NULL) {
+               printf("OMPTR ERROR: not enough memory!\n");
+               exit(-1);
+          }
      }
+     task->children[task->numChildren++] = new_task_id;
+
+     OMPTR_FORK(*bb_id_ptr, new_task_bb_id, new_bb_id)
 
      // return value
      *bb_id_ptr = new_task_bb_id;
@@ -122,43 +287,39 @@ int omptr_task(int *bb_id_ptr) {
 }
 
 void omptr_task_wait(int *bb_id_ptr) {
-     BasicBlock *bb = &BBs[*bb_id_ptr];
-     OmptrTask *task = &Tasks[bb->taskID];
+     BasicBlock *bb = omptr_bb(*bb_id_ptr);
+     OmptrTask *task = omptr_task_record(bb->taskID);
 
-     int new_bb_id;
      // create new bb for current task
-     #pragma omp atomic capture
-     new_bb_id = ++BB_Counter;
-
-     if (new_bb_id >= MAX_NUM_BB) {
-          printf("OMPTR ERROR: maximum number of basic blocks exceeds!\n");
-          exit(-1); 
-     }
-     BasicBlock *new_bb = &BBs[new_bb_id];
+     int new_bb_id = omptr_next_id(&BB_Counter);
+     BasicBlock *new_bb = omptr_bb(new_bb_id);
      new_bb->taskID = bb->taskID;
      new_bb->nodeID = bb->nodeID + 1;
 
      // record tasks waiting for
-     for (int i = 0; i < task->numChildren; ++i) {
-          new_bb->waitFor[i] = task->children[i];
+     if (task->numChildren > 0) {
+          new_bb->waitFor = omptr_arena_alloc(task->numChildren);
+          memcpy(new_bb->waitFor, task->children, task->numChildren * sizeof(int));
      }
      new_bb->numTasksWaitingFor = task->numChildren;
      task->numChildren = 0;  // reset task children
 
+     OMPTR_JOIN(*bb_id_ptr, new_bb_id)
+
      *bb_id_ptr = new_bb_id;
 }
 
-void printBasicBlockJSON(FILE *file, BasicBlock bb, int bb_id) {
+void printBasicBlockJSON(FILE *file, const BasicBlock *bb, int bb_id) {
     fprintf(file, "{\n");
     fprintf(file, "  \"ID\": %d,\n", bb_id);
-    fprintf(file, "  \"taskID\": %d,\n", bb.taskID);
-    fprintf(file, "  \"nodeID\": %d,\n", bb.nodeID);
-    fprintf(file, "  \"taskCreated\": %d,\n", bb.taskCreated);
-    fprintf(file, "  \"numTasksWaitingFor\": %d,\n", bb.numTasksWaitingFor);
+    fprintf(file, "  \"taskID\": %d,\n", bb->taskID);
+    fprintf(file, "  \"nodeID\": %d,\n", bb->nodeID);
+    fprintf(file, "  \"taskCreated\": %d,\n", bb->taskCreated);
+    fprintf(file, "  \"numTasksWaitingFor\": %d,\n", bb->numTasksWaitingFor);
     fprintf(file, "  \"waitFor\": [");
-    for (int i = 0; i < bb.numTasksWaitingFor; i++) {
-        fprintf(file, "%d", bb.waitFor[i]);
-        if (i < bb.numTasksWaitingFor - 1) {
+    for (int i = 0; i < bb->numTasksWaitingFor; i++) {
+        fprintf(file, "%d", bb->waitFor[i]);
+        if (i < bb->numTasksWaitingFor - 1) {
             fprintf(file, ", ");
         }
     }
@@ -166,26 +327,78 @@ void printBasicBlockJSON(FILE *file, BasicBlock bb, int bb_id) {
     fprintf(file, "}\n");
 }
 
+/*
+ * Binary DAG format, read by parse_dag of the analyzer (little-endian):
+ *   "OMPTRDAG", uint32 version (1), uint32 reserved (0), uint64 number of basic blocks,
+ *   then for every basic block in ID order:
+ *   int32 taskID, int32 nodeID, int32 taskCreated, int32 numTasksWaitingFor, int32 waitFor[numTasksWaitingFor]
+ */
+void printBasicBlockBinary(FILE *file, const BasicBlock *bb) {
+    int32_t fields[4] = {bb->taskID, bb->nodeID, bb->taskCreated, bb->numTasksWaitingFor};
+    fwrite(fields, sizeof(int32_t), 4, file);
+    fwrite(bb->waitFor, sizeof(int32_t), bb->numTasksWaitingFor, file);
+}
+
+/*
+ * The DAG is written in the binary format if the file name ends with .dag, in JSON otherwise.
+ */
 void omptr_print(const char *filename) {
      FILE *outputFile;
 
      // Open the file for writing
-     if ((outputFile = fopen(filename, "w")) == NULL) {
+     if ((outputFile = fopen(filename, "wb")) == NULL) {
           fprintf(stderr, "OMPTR ERROR: Error opening file for writing.\n");
           exit(-1);
      }
-
-     fprintf(outputFile, "[\n");
+     setvbuf(outputFile, NULL, _IOFBF, 1 << 20);
+
+     size_t length = strlen(filename);
+     int binary = length >= 4 && strcmp(filename + length - 4, ".dag") == 0;
+     if (binary) {
+          uint32_t header[2] = {1, 0};
+          uint64_t num_bbs = BB_Counter + 1;
+          fwrite("OMPTRDAG", 1, 8, outputFile);
+          fwrite(header, sizeof(uint32_t), 2, outputFile);
+          fwrite(&num_bbs, sizeof(uint64_t), 1, outputFile);
+     } else {
+          fprintf(outputFile, "[\n");
+     }
      for (int i = 0; i <= BB_Counter; ++i) {
-          printBasicBlockJSON(outputFile, BBs[i], i);
-          if (i < BB_Counter) {
-               fprintf(outputFile, ",\n");
+          if (binary) {
+               printBasicBlockBinary(outputFile, omptr_bb(i));
+          } else {
+               printBasicBlockJSON(outputFile, omptr_bb(i), i);
+               if (i < BB_Counter) {
+                    fprintf(outputFile, ",\n");
+               }
           }
      }
-     fprintf(outputFile, "]\n");
+     if (!binary) {
+          fprintf(outputFile, "]\n");
+     }
+     if (ferror(outputFile)) {
+          fprintf(stderr, "OMPTR ERROR: Error writing file.\n");
+          exit(-1);
+     }
      fclose(outputFile);
-     free(BBs);
-     free(Tasks);
+
+     for (int i = 0; i < OMPTR_NUM_CHUNKS; ++i) {
+          if (Task_Chunks[i] != NULL) {
+               for (int j = 0; j < OMPTR_CHUNK_SIZE; ++j) {
+                    free(Task_Chunks[i][j].children);
+               }
+          }
+          free(BB_Chunks[i]);
+          free(Task_Chunks[i]);
+     }
+     free(BB_Chunks);
+     free(Task_Chunks);
+     while (Arena_Chunks != NULL) {
+          OmptrArenaChunk *next = Arena_Chunks->next;
+          free(Arena_Chunks);
+          Arena_Chunks = next;
+     }
+     omptr_arena = NULL;
 }
 
 // OMPTR macros
@@ -195,12 +408,12 @@ void omptr_print(const char *filename) {
 
 #define OMPTR_TASK_START() \
      asm volatile("" ::: "memory"); \
-     printf("[OMPTR] BB %d starts.\n", omptr_bb_id); \
+     OMPTR_BB_STARTS(omptr_bb_id) \
      asm volatile("" ::: "memory");
 
 #define OMPTR_TASK_END() \
      asm volatile("" ::: "memory"); \
-     printf("[OMPTR] BB %d ends.\n", omptr_bb_id); \
+     OMPTR_BB_ENDS(omptr_bb_id) \
      asm volatile("" ::: "memory");
 
 #define OMPTR_NEW_CONTEXT() \
@@ -216,31 +429,39 @@ void omptr_print(const char *filename) {
 
 #define OMPTR_BEFORE_TASK() \
      asm volatile("" ::: "memory"); \
-     printf("[OMPTR] BB %d ends.\n", omptr_bb_id); \
+     OMPTR_BB_ENDS(omptr_bb_id) \
      omptr_new_bb_id = omptr_task(&omptr_bb_id); \
      asm volatile("" ::: "memory");
 
 #define OMPTR_AFTER_TASK() \
      asm volatile("" ::: "memory"); \
      omptr_bb_id = omptr_new_bb_id; \
-     printf("[OMPTR] BB %d starts.\n", omptr_bb_id); \
+     OMPTR_BB_STARTS(omptr_bb_id) \
      asm volatile("" ::: "memory");
 
 #define OMPTR_BEFORE_TASKWAIT() \
      asm volatile("" ::: "memory"); \
-     printf("[OMPTR] BB %d ends.\n", omptr_bb_id); \
+     OMPTR_BB_ENDS(omptr_bb_id) \
      omptr_task_wait(&omptr_bb_id); \
      asm volatile("" ::: "memory");
 
 #define OMPTR_AFTER_TASKWAIT() \
      asm volatile("" ::: "memory"); \
-     printf("[OMPTR] BB %d starts.\n", omptr_bb_id); \
+     OMPTR_BB_STARTS(omptr_bb_id) \
      asm volatile("" ::: "memory");
 
 #define OMPTR_PRINT(fn) \
      omptr_print(fn);
 
-// Instumentation Rules:
+// Move LLC ways between partitions (requires resizable partitions in the simulator),
+// e.g. at a basic block boundary
+#define OMPTR_PAR_MOVE_WAYS(src, dst, num_ways) \
+     asm volatile("" ::: "memory"); \
+     OMPTR_PAR(src, dst, num_ways) \
+     asm volatile("" ::: "memory");
+
+// Instumentation Rules (compile with -DOMPTR_USE_M5OPS to emit the markers as m5 pseudo-instructions,
+// and with -DOMPTR_ONLINE for the online classification of the simulator):
 // 1. Main function (Note: make sure OMPTR_TASK_START() AND OMPTR_TASK_END() are placed in the same scope)
 //   OMPTR_INIT();
 //   #pragma omp single
@@ -249,7 +470,7 @@ void omptr_print(const char *filename) {
 //        ... // main task
 //        OMPTR_TASK_END();
 //   }
-//   OMPTR_PRINT("omptr.json");
+//   OMPTR_PRINT("omptr.json");  // or "omptr.dag" for the compact binary format
 //
 // 2. Rule for #pragma omp task
 //   OMPTR_BEFORE_TASK();
@@ -7,6 +7,9 @@ import os
 
 from multiprocessing.pool import Pool
 
+# Modify here to evaluate a sweep table (see omptr/analyzer/sweep.csv) instead of the default configurations
+sweep_table = None
+
 
 def generate_analyzer_command(config_name):
     config_fields = config_name.split('-')
@@ -16,10 +19,17 @@ def generate_analyzer_command(config_name):
     analyzer_bin = f"{gem5_home}/omptr/analyzer/analyzer"
     config_dir = f"{gem5_home}/bots-out/{config_name}"
     mem_stats_file = f"{config_dir}/mem.stats.gz"
-    dag_json = f"{config_dir}/{program_name}.json"
+    # the BOTS programs write the DAG in the binary format, the examples in JSON
+    dag_json = f"{config_dir}/{program_name}.dag"
+    if not os.path.exists(dag_json):
+        dag_json = f"{config_dir}/{program_name}.json"
     output_csv = f"{config_dir}/{program_name}.csv"
     
     command = f"{analyzer_bin} {mem_stats_file} {dag_json} {num_cores} {output_csv}"
+    if sweep_table is not None:
+        # all the configurations of the table in one run
+        sweep_csv = f"{config_dir}/{program_name}-sweep.csv"
+        command = f"{analyzer_bin} --sweep {mem_stats_file} {dag_json} {sweep_table} {sweep_csv}"
     
     return (command, config_dir, config_dir, config_name)
 
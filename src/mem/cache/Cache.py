@@ -105,6 +105,9 @@ class BaseCache(ClockedObject):
     tags = Param.BaseTags(BaseSetAssoc(), "Tag store")
     replacement_policy = Param.BaseReplacementPolicy(LRURP(),
         "Replacement policy")
+    par_requestors = VectorParam.String([], "Requestor name prefix of "
+        "each partition of a partitioned replacement policy (e.g. "
+        "system.cpu0), requestors matching no prefix do not allocate")
 
     compressor = Param.BaseCacheCompressor(NULL, "Cache compressor.")
     replace_expansions = Param.Bool(True, "Apply replacement policy to " \
@@ -57,6 +57,7 @@
 #include "mem/cache/mshr.hh"
 #include "mem/cache/prefetch/base.hh"
 #include "mem/cache/queue_entry.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
 #include "mem/cache/tags/compressed_tags.hh"
 #include "mem/cache/tags/super_blk.hh"
 #include "params/BaseCache.hh"
@@ -104,6 +105,7 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
       isReadOnly(p.is_read_only),
       replaceExpansions(p.replace_expansions),
       moveContractions(p.move_contractions),
+      parRequestors(p.par_requestors),
       blocked(0),
       order(0),
       noTargetMSHR(nullptr),
@@ -134,6 +136,18 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
         "Compressed cache %s does not have a compression algorithm", name());
     if (compressor)
         compressor->setCache(this);
+
+    const auto* par_policy =
+        dynamic_cast<replacement_policy::Par*>(p.replacement_policy);
+    fatal_if(par_policy && parRequestors.empty(),
+        "Cache %s uses a partitioned replacement policy, but does not map "
+        "requestors to partitions (par_requestors)", name());
+    fatal_if(!par_policy && !parRequestors.empty(),
+        "Cache %s maps requestors to partitions, but does not use a "
+        "partitioned replacement policy", name());
+    fatal_if(par_policy && par_policy->getNumPar() != parRequestors.size(),
+        "Cache %s has %d partitions but %d partition requestors", name(),
+        par_policy->getNumPar(), parRequestors.size());
 }
 
 BaseCache::~BaseCache()
@@ -1237,7 +1251,11 @@ BaseCache::access(PacketPtr pkt, CacheBlk *&blk, Cycles &lat,
 
     // Access block in the tags
     Cycles tag_latency(0);
-    blk = tags->accessBlock(pkt, tag_latency);
+    if (parRequestors.empty()) {
+        blk = tags->accessBlock(pkt, tag_latency);
+    } else {
+        blk = tags->accessBlock(pkt, tag_latency, getParId(pkt));
+    }
 
     DPRINTF(Cache, "%s for %s %s\n", __func__, pkt->print(),
             blk ? "hit " + blk->print() : "miss");
@@ -1610,6 +1628,12 @@ BaseCache::allocateBlock(const PacketPtr pkt, PacketList &writebacks)
     // Get secure bit
     const bool is_secure = pkt->isSecure();
 
+    // Requestors that do not belong to a partition cannot allocate
+    const int par_id = parRequestors.empty() ? -1 : getParId(pkt);
+    if (!parRequestors.empty() && par_id < 0) {
+        return nullptr;
+    }
+
     // Block size and compression related access latency. Only relevant if
     // using a compressor, otherwise there is no extra delay, and the block
     // is fully sized
@@ -1630,8 +1654,9 @@ BaseCache::allocateBlock(const PacketPtr pkt, PacketList &writebacks)
 
     // Find replacement victim
     std::vector<CacheBlk*> evict_blks;
-    CacheBlk *victim = tags->findVictim(addr, is_secure, blk_size_bits,
-                                        evict_blks);
+    CacheBlk *victim = parRequestors.empty() ?
+        tags->findVictim(addr, is_secure, blk_size_bits, evict_blks) :
+        tags->findVictim(addr, is_secure, blk_size_bits, evict_blks, par_id);
 
     // It is valid to return nullptr if there is no victim
     if (!victim)
@@ -1646,7 +1671,11 @@ BaseCache::allocateBlock(const PacketPtr pkt, PacketList &writebacks)
     }
 
     // Insert new block at victimized entry
-    tags->insertBlock(pkt, victim);
+    if (parRequestors.empty()) {
+        tags->insertBlock(pkt, victim);
+    } else {
+        tags->insertBlock(pkt, victim, par_id);
+    }
 
     // If using a compressor, set compression data. This must be done after
     // insertion, as the compression bit may be set.
@@ -1658,6 +1687,35 @@ BaseCache::allocateBlock(const PacketPtr pkt, PacketList &writebacks)
     return victim;
 }
 
+int
+BaseCache::getParId(const PacketPtr pkt)
+{
+    const RequestorID requestor_id = pkt->req->requestorId();
+    auto it = parIds.find(requestor_id);
+    if (it != parIds.end()) {
+        return it->second;
+    }
+
+    // Match the requestor name against the prefixes, on a name component
+    // boundary so that e.g. system.cpu1 does not match system.cpu10
+    const std::string requestor_name =
+        system->getRequestorName(requestor_id);
+    int par_id = -1;
+    for (int i = 0; i < parRequestors.size(); ++i) {
+        const std::string& prefix = parRequestors[i];
+        if (requestor_name.compare(0, prefix.size(), prefix) == 0 &&
+            (requestor_name.size() == prefix.size() ||
+             requestor_name[prefix.size()] == '.')) {
+            par_id = i;
+            break;
+        }
+    }
+    DPRINTF(CacheRepl, "Requestor %s is in partition %d\n",
+            requestor_name, par_id);
+    parIds.emplace(requestor_id, par_id);
+    return par_id;
+}
+
 void
 BaseCache::invalidateBlock(CacheBlk *blk)
 {
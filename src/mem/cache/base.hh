@@ -49,6 +49,8 @@
 #include <cassert>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "base/addr_range.hh"
 #include "base/compiler.hh"
@@ -800,6 +802,18 @@ class BaseCache : public ClockedObject
      * @return the allocated block
      */
     CacheBlk *allocateBlock(const PacketPtr pkt, PacketList &writebacks);
+
+    /**
+     * Get the partition of the requestor of a packet, when the tags use a
+     * partitioned replacement policy. The requestor belongs to partition i
+     * if its name starts with the i-th entry of parRequestors.
+     *
+     * @param pkt The packet.
+     * @return The partition, -1 if the requestor does not belong to any
+     *         partition (e.g. writebacks of the caches above).
+     */
+    int getParId(const PacketPtr pkt);
+
     /**
      * Evict a cache block.
      *
@@ -958,6 +972,15 @@ class BaseCache : public ClockedObject
      */
     const bool moveContractions;
 
+    /**
+     * Requestor name prefix of each partition of the partitioned
+     * replacement policy, empty if the replacement policy is not partitioned.
+     */
+    const std::vector<std::string> parRequestors;
+
+    /** Partition of each requestor seen so far. */
+    std::unordered_map<RequestorID, int> parIds;
+
     /**
      * Bit vector of the blocking reasons for the access path.
      * @sa #BlockedCause
@@ -0,0 +1,10 @@
+from m5.params import *
+from m5.SimObject import SimObject
+
+class ParUtilityMonitor(SimObject):
+    type = 'ParUtilityMonitor'
+    cxx_class = 'gem5::replacement_policy::ParUtilityMonitor'
+    cxx_header = "mem/cache/replacement_policies/par_ucp.hh"
+    sampling_interval = Param.Unsigned(32, "Monitor one cache set out of sampling_interval")
+    repartition_period = Param.Latency('100us', "Period of the partition size updates")
+    min_ways = Param.Unsigned(1, "Minimum number of ways per partition")
@@ -26,7 +26,7 @@
 
 from m5.params import *
 from m5.proxy import *
-from m5.SimObject import SimObject
+from m5.SimObject import SimObject, cxxMethod
 
 class BaseReplacementPolicy(SimObject):
     type = 'BaseReplacementPolicy'
@@ -157,3 +157,43 @@ class ParRP(BaseReplacementPolicy):
     replacement_policy = Param.BaseReplacementPolicy(LRURP(), "Implemented replacement policy")
     par_config = VectorParam.Int([-1], "Partition configuration")
     num_way = Param.Int(1, "Number of cache ways in a cache set")
+    resizable = Param.Bool(False, "Allow resizing the partitions at runtime")
+    utility_monitor = Param.ParUtilityMonitor(NULL,
+        "Utility monitor sizing the partitions (requires resizable)")
+    stats_sampling_interval = Param.Unsigned(64,
+        "Only one cache set out of stats_sampling_interval updates the per-set statistics")
+    way_masks = VectorParam.UInt64([],
+        "Ways each partition can allocate in (way-mask mode), par_config is then ignored")
+
+    @cxxMethod
+    def resize(self, par_config):
+        """Resize the partitions, the new sizes must sum up to num_way"""
+        pass
+
+    @cxxMethod
+    def moveWays(self, src_par_id, dst_par_id, num_ways):
+        """Move ways from a partition to another"""
+        pass
+
+    @cxxMethod
+    def setWayMask(self, par_id, way_mask):
+        """Change the ways a partition can allocate in (way-mask mode)"""
+        pass
+
+class ParLRURP(ParRP):
+    type = 'ParLRURP'
+    cxx_class = 'gem5::replacement_policy::ParLRU'
+    cxx_header = "mem/cache/replacement_policies/par_native_rp.hh"
+    replacement_policy = NULL
+
+class ParFIFORP(ParRP):
+    type = 'ParFIFORP'
+    cxx_class = 'gem5::replacement_policy::ParFIFO'
+    cxx_header = "mem/cache/replacement_policies/par_native_rp.hh"
+    replacement_policy = NULL
+
+class ParTreePLRURP(ParRP):
+    type = 'ParTreePLRURP'
+    cxx_class = 'gem5::replacement_policy::ParTreePLRU'
+    cxx_header = "mem/cache/replacement_policies/par_native_rp.hh"
+    replacement_policy = NULL
@@ -0,0 +1,30 @@
+#include "mem/cache/replacement_policies/par_native_rp.hh"
+
+#include "params/ParFIFORP.hh"
+#include "params/ParLRURP.hh"
+#include "params/ParTreePLRURP.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
+namespace replacement_policy
+{
+
+ParLRU::ParLRU(const Params &p)
+  : ParNative<ParLRUKernel>(p)
+{
+}
+
+ParFIFO::ParFIFO(const Params &p)
+  : ParNative<ParFIFOKernel>(p)
+{
+}
+
+ParTreePLRU::ParTreePLRU(const Params &p)
+  : ParNative<ParTreePLRUKernel>(p)
+{
+}
+
+} // namespace replacement_policy
+} // namespace gem5
@@ -0,0 +1,263 @@
+/**
+ * @file
+ * Native partitioned replacement policies.
+ * They keep the partition bookkeeping of the Par replacement policy, but store
+ * the replacement state of each partition inline in the cache set instead of
+ * wrapping a generic replacement policy:
+ * - ParLRU keeps one last-touch tick per partition entry,
+ * - ParFIFO keeps one insertion tick per partition entry,
+ * - ParTreePLRU keeps one PLRU bit-tree per partition.
+ * ParLRU and ParFIFO select the same victims as ParRP wrapping LRURP and FIFORP.
+ * ParTreePLRU has no ParRP counterpart, as the trees of a wrapped TreePLRURP span
+ * several partitions. Each of its trees selects the same victims as TreePLRURP
+ * managing a full partition alone, with the partition slots as leaves; partitions
+ * whose size is not a power of 2 never select their padding leaves.
+ * See par_rp.test.cc for the checks.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_POLICIES_PAR_NATIVE_RP_HH__
+#define __MEM_CACHE_REPLACEMENT_POLICIES_PAR_NATIVE_RP_HH__
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+struct ParLRURPParams;
+struct ParFIFORPParams;
+struct ParTreePLRURPParams;
+
+GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
+namespace replacement_policy
+{
+
+/**
+ * Kernels operate on the state of a single partition that can hold up to par_size entries.
+ * Entries are identified by their index (slot) in the partition.
+ * The victim is selected among the occupied slots, given as a bitmask.
+ */
+
+/** Timestamp kernel: one tick per entry, the oldest entry is the victim. */
+template <bool TouchUpdates>
+struct ParTickKernel
+{
+    static int stateSize(int par_size) { return par_size; }
+
+    static void
+    reset(uint64_t* state, int par_size, int slot)
+    {
+        state[slot] = curTick();
+    }
+
+    static void
+    touch(uint64_t* state, int par_size, int slot)
+    {
+        if (TouchUpdates) {
+            state[slot] = curTick();
+        }
+    }
+
+    static void
+    invalidate(uint64_t* state, int par_size, int slot)
+    {
+        state[slot] = 0;
+    }
+
+    template <class Entry>
+    static int
+    getVictim(const uint64_t* state, const Entry* entries, int par_size, uint64_t occupied)
+    {
+        // Oldest entry first, the entry with the lower way first among equally old entries,
+        // which is the order in which the wrapped policy visits its candidates
+        int victim = ctz64(occupied);
+        for (uint64_t rest = occupied & (occupied - 1); rest; rest &= rest - 1) {
+            int i = ctz64(rest);
+            bool older = (state[i] < state[victim]) |
+                ((state[i] == state[victim]) & (entries[i].way_index < entries[victim].way_index));
+            victim = older ? i : victim;
+        }
+        return victim;
+    }
+};
+
+typedef ParTickKernel<true> ParLRUKernel;
+typedef ParTickKernel<false> ParFIFOKernel;
+
+/**
+ * Tree-PLRU kernel: one bit-tree per partition, packed in a single word.
+ * The tree has as many leaves as the partition size rounded up to a power of 2,
+ * and is indexed as in TreePLRU: the root is node 0 and the children of node i are
+ * nodes 2i+1 (left) and 2i+2 (right). A set bit points to the right subtree.
+ */
+struct ParTreePLRUKernel
+{
+    static int stateSize(int par_size) { return 1; }
+
+    /** Index of the first leaf, i.e. the number of internal nodes. */
+    static uint64_t
+    firstLeafIndex(int par_size)
+    {
+        return alignToPowerOfTwo(par_size) - 1;
+    }
+
+    /** Make every node on the path to the leaf point to (or away from) it. */
+    static void
+    point(uint64_t* state, int par_size, int slot, bool towards)
+    {
+        uint64_t tree_index = slot + firstLeafIndex(par_size);
+        while (tree_index != 0) {
+            const uint64_t right = (tree_index % 2 == 0) ^ !towards;
+            tree_index = (tree_index - 1) / 2;
+            state[0] = (state[0] & ~(1ULL << tree_index)) | (right << tree_index);
+        }
+    }
+
+    static void
+    reset(uint64_t* state, int par_size, int slot)
+    {
+        // A reset has the same functionality of a touch
+        touch(state, par_size, slot);
+    }
+
+    static void
+    touch(uint64_t* state, int par_size, int slot)
+    {
+        point(state, par_size, slot, false);
+    }
+
+    static void
+    invalidate(uint64_t* state, int par_size, int slot)
+    {
+        point(state, par_size, slot, true);
+    }
+
+    template <class Entry>
+    static int
+    getVictim(const uint64_t* state, const Entry* entries, int par_size, uint64_t occupied)
+    {
+        uint64_t tree_index = 0;
+        // Leaves of the current subtree are [first_slot, first_slot + num_slots)
+        uint64_t first_slot = 0;
+        uint64_t num_slots = alignToPowerOfTwo(par_size);
+        while (num_slots > 1) {
+            num_slots /= 2;
+            const uint64_t right_slot = first_slot + num_slots;
+            const uint64_t right_mask = mask(num_slots) << right_slot;
+            bool right = (state[0] >> tree_index) & 1;
+            // Never descend into a subtree without occupied leaves (e.g. padding leaves)
+            if (right) {
+                right = occupied & right_mask;
+            } else {
+                right = !(occupied & (mask(num_slots) << first_slot));
+            }
+            tree_index = 2 * tree_index + 1 + right;
+            first_slot = right ? right_slot : first_slot;
+        }
+        return first_slot;
+    }
+};
+
+/**
+ * Partitioned replacement policy specialized at compile time for a kernel.
+ */
+template <class Kernel>
+class ParNative : public Par
+{
+    protected:
+        /** Offset of the state of each partition in the native state of a set. */
+        std::vector<int> stateOffset;
+
+        /** Number of state words per cache set. */
+        int stateSize;
+
+        uint64_t*
+        parState(ParSetState& par_set, int par_id) const
+        {
+            return par_set.native.data() + stateOffset[par_id];
+        }
+
+        void
+        resetParEntry(ParSetState& par_set, int par_id, int slot) override
+        {
+            Kernel::reset(parState(par_set, par_id), parCapacity[par_id], slot);
+        }
+
+        void
+        touchParEntry(ParSetState& par_set, int par_id, int slot) override
+        {
+            Kernel::touch(parState(par_set, par_id), parCapacity[par_id], slot);
+        }
+
+        void
+        invalidateParEntry(ParSetState& par_set, int par_id, int slot) override
+        {
+            Kernel::invalidate(parState(par_set, par_id), parCapacity[par_id], slot);
+        }
+
+        int
+        getParVictim(ParSetState& par_set, int par_id,
+                     const ReplacementCandidates& candidates) const override
+        {
+            // partition must be full, or over its size after a resize
+            assert(par_set.occupancy[par_id] > 0);
+            assert(par_set.occupancy[par_id] >= par_config[par_id]);
+            const int capacity = parCapacity[par_id];
+            const uint64_t occupied = ~par_set.vacant[par_id] & mask(capacity);
+            const ParEntry* entries = &par_set.entries[parOffset[par_id]];
+            int slot = Kernel::getVictim(parState(par_set, par_id), entries,
+                                         capacity, occupied);
+            return entries[slot].way_index;
+        }
+
+        std::shared_ptr<ReplacementData>
+        instantiateParEntry() override
+        {
+            // the replacement state lives in the set
+            return nullptr;
+        }
+
+        void
+        instantiateParSet(ParSetState& par_set) override
+        {
+            par_set.native.assign(stateSize, 0);
+        }
+
+    public:
+        ParNative(const ParRPParams &p)
+          : Par(p, false), stateSize(0)
+        {
+            for (int par_capacity : parCapacity) {
+                stateOffset.push_back(stateSize);
+                stateSize += Kernel::stateSize(par_capacity);
+            }
+        }
+};
+
+class ParLRU : public ParNative<ParLRUKernel>
+{
+    public:
+        typedef ParLRURPParams Params;
+        ParLRU(const Params &p);
+};
+
+class ParFIFO : public ParNative<ParFIFOKernel>
+{
+    public:
+        typedef ParFIFORPParams Params;
+        ParFIFO(const Params &p);
+};
+
+class ParTreePLRU : public ParNative<ParTreePLRUKernel>
+{
+    public:
+        typedef ParTreePLRURPParams Params;
+        ParTreePLRU(const Params &p);
+};
+
+} // namespace replacement_policy
+} // namespace gem5
+
+#endif // __MEM_CACHE_REPLACEMENT_POLICIES_PAR_NATIVE_RP_HH__
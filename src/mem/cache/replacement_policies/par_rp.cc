@@ -4,14 +4,17 @@
 
 #include "mem/cache/replacement_policies/par_rp.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
 #include "params/ParRP.hh"
 #include "sim/cur_tick.hh"
 #include <cstdlib>
+#include "base/bitfield.hh"
 #include "base/trace.hh"
 #include "debug/RP.hh"
+#include "mem/cache/replacement_policies/par_ucp.hh"
 
 namespace gem5
 {
@@ -20,23 +23,268 @@ GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
 namespace replacement_policy
 {
 
+std::vector<Par*> Par::instances;
+
 Par::Par(const Params &p)
+  : Par(p, true)
+{
+}
+
+Par::Par(const ParRPParams &p, bool wrap_policy)
   : Base(p), replPolicy(p.replacement_policy), 
-    par_config(p.par_config),
+    // in way-mask mode, the size of a partition is the number of ways it can allocate in
+    par_config(p.way_masks.empty() ? p.par_config : std::vector<int>(p.way_masks.size())),
     num_way(p.num_way),
+    resizable(p.resizable),
+    wayMaskMode(!p.way_masks.empty()),
+    wayMasks(p.way_masks),
+    utilityMonitor(p.utility_monitor),
+    statsSamplingInterval(p.stats_sampling_interval),
     m_count(0),
-    parTableInstance(nullptr),
-    ownerTableInstance(nullptr)
+    parStats(*this)
 {
-    fatal_if(replPolicy == nullptr,
+    fatal_if(statsSamplingInterval == 0,
+        "The statistics sampling interval must be at least 1.");
+    fatal_if(wrap_policy && replPolicy == nullptr,
         "Replacement policy must be instantiated");
 
+    if (wayMaskMode) {
+        fatal_if(!wrap_policy,
+            "Way masks require a wrapped replacement policy (ParRP).");
+        fatal_if(resizable || utilityMonitor != nullptr,
+            "Way-masked partitions are reconfigured with setWayMask(), not resized.");
+        fatal_if(num_way > 64, "Way masks support at most 64 ways.");
+        fatal_if(wayMasks.size() > 64, "At most 64 partitions are supported.");
+        for (int i = 0; i < wayMasks.size(); ++i) {
+            par_config[i] = checkWayMask(wayMasks[i]);
+        }
+        parCandidates.reserve(num_way);
+        return;
+    }
+
+    // one owner bit per partition in the owner word of a cache way
+    fatal_if(par_config.size() > 64,
+        "At most 64 partitions are supported.");
+
+    fatal_if(resizable && num_way > 64,
+        "A resizable partition can hold at most 64 entries.");
+
     int tot_par_size = 0;
+    int tot_par_capacity = 0;
     for (int i = 0; i < par_config.size(); ++i) {
+        fatal_if(par_config[i] > 64,
+            "A partition can hold at most 64 entries.");
         tot_par_size += par_config[i];
+        parCapacity.push_back(resizable ? num_way : par_config[i]);
+        parOffset.push_back(tot_par_capacity);
+        tot_par_capacity += parCapacity[i];
+    }
+    fatal_if(tot_par_size != num_way,
+        "The total number of entries across all partitions must be equal to the number of ways.");
+
+    parCandidates.reserve(num_way);
+    // only resizable partitions can be resized from the simulated program
+    if (resizable) {
+        instances.push_back(this);
+    }
+
+    if (utilityMonitor != nullptr) {
+        fatal_if(!resizable,
+            "Partitions sized by a utility monitor must be resizable.");
+        utilityMonitor->setPolicy(this, par_config, num_way);
+    }
+}
+
+Par::~Par()
+{
+    instances.erase(std::remove(instances.begin(), instances.end(), this),
+                    instances.end());
+}
+
+void
+Par::resize(const std::vector<int>& new_par_config)
+{
+    fatal_if(!resizable,
+        "Partitions can only be resized when the resizable parameter is set.");
+    fatal_if(new_par_config.size() != par_config.size(),
+        "The number of partitions cannot be changed at runtime.");
+
+    int tot_par_size = 0;
+    for (int par_size : new_par_config) {
+        fatal_if(par_size < 1, "A partition must keep at least one way.");
+        tot_par_size += par_size;
     }
     fatal_if(tot_par_size != num_way,
         "The total number of entries across all partitions must be equal to the number of ways.");
+
+    for (int i = 0; i < par_config.size(); ++i) {
+        DPRINTFR(RP, "resize: par %d from %d to %d\n", i, par_config[i], new_par_config[i]);
+    }
+    // Excess entries of shrunk partitions are left in place:
+    // parAvail() reports the partition as full until enough of them are replaced
+    par_config = new_par_config;
+}
+
+int
+Par::checkWayMask(uint64_t way_mask) const
+{
+    fatal_if(way_mask == 0, "A way mask must hold at least one way.");
+    fatal_if(num_way < 64 && (way_mask >> num_way) != 0,
+        "Way mask %#x holds ways beyond the %d ways of the set.", way_mask, num_way);
+    return popCount(way_mask);
+}
+
+void
+Par::setWayMask(int par_id, uint64_t way_mask)
+{
+    fatal_if(!wayMaskMode, "Way masks can only be set in way-mask mode.");
+    fatal_if(par_id < 0 || par_id >= wayMasks.size(), "Invalid partition id.");
+    DPRINTFR(RP, "setWayMask: par %d from %#x to %#x\n", par_id, wayMasks[par_id], way_mask);
+    // Lines outside the new mask are left in place, they are replaced by the other partitions
+    par_config[par_id] = checkWayMask(way_mask);
+    wayMasks[par_id] = way_mask;
+}
+
+void
+Par::moveWays(int src_par_id, int dst_par_id, int num_ways)
+{
+    fatal_if(src_par_id < 0 || src_par_id >= par_config.size() ||
+             dst_par_id < 0 || dst_par_id >= par_config.size(),
+        "Invalid partition id.");
+    fatal_if(num_ways > par_config[src_par_id],
+        "Cannot move more ways than the source partition holds.");
+
+    std::vector<int> new_par_config = par_config;
+    new_par_config[src_par_id] -= num_ways;
+    new_par_config[dst_par_id] += num_ways;
+    resize(new_par_config);
+}
+
+void
+Par::moveWaysAll(int src_par_id, int dst_par_id, int num_ways)
+{
+    warn_if(instances.empty(),
+        "No resizable partitions to move ways in, set the resizable parameter.");
+    for (Par* par : instances) {
+        par->moveWays(src_par_id, dst_par_id, num_ways);
+    }
+}
+
+void
+Par::sampleParSet(const ParSetState& par_set)
+{
+    for (int i = 0; i < par_config.size(); ++i) {
+        parStats.m_occupancy[i].sample(par_set.occupancy[i]);
+    }
+    int shared_ways = 0;
+    for (uint64_t owners : par_set.owners) {
+        shared_ways += popCount(owners) > 1;
+    }
+    parStats.m_shared_ways.sample(shared_ways);
+}
+
+Par::ParStats::ParStats(Par &parent)
+    : statistics::Group(&parent),
+      ADD_STAT(m_par_hit, statistics::units::Count::get(),
+               "Accesses to entries owned by the partition (sampled sets)"),
+      ADD_STAT(m_par_miss, statistics::units::Count::get(),
+               "Accesses that bring an entry in the partition (sampled sets)"),
+      ADD_STAT(m_shared_claim, statistics::units::Count::get(),
+               "Partition misses on entries owned by another partition (sampled sets)"),
+      ADD_STAT(m_occupancy, statistics::units::Count::get(),
+               "Entries held by the partition on each access (sampled sets)"),
+      ADD_STAT(m_shared_ways, statistics::units::Count::get(),
+               "Ways owned by more than one partition on each access (sampled sets)"),
+      ADD_STAT(m_par_replacement, statistics::units::Count::get(),
+               "Partition victims selected (Par_Replacement)"),
+      ADD_STAT(m_par_eviction, statistics::units::Count::get(),
+               "Entries removed from the partition"),
+      ADD_STAT(m_phy_replacement, statistics::units::Count::get(),
+               "Entries removed from the cache (Phy_Replacement)")
+{
+    const int par_num = parent.par_config.size();
+    m_par_hit.init(par_num);
+    m_par_miss.init(par_num);
+    m_shared_claim.init(par_num);
+    m_occupancy
+        .init(par_num, 0, parent.num_way, 1)
+        .flags(statistics::nozero);
+    m_shared_ways
+        .init(0, parent.num_way, 1)
+        .flags(statistics::nozero);
+    m_par_replacement.init(par_num);
+    m_par_eviction.init(par_num);
+}
+
+Par::ParEntry*
+Par::claim(ParSetState& par_set, int way_index, int par_id)
+{
+    // there must be at least one vacant partition entry
+    assert(par_set.vacant[par_id] != 0);
+    // take the vacant entry with the lowest index
+    int slot = ctz64(par_set.vacant[par_id]);
+    par_set.vacant[par_id] &= ~(1ULL << slot);
+    par_set.occupancy[par_id]++;
+    // update owner table
+    par_set.owners[way_index] |= 1ULL << par_id;
+    par_set.slots[par_id * num_way + way_index] = slot;
+    // link par entry
+    ParEntry& par_entry = par_set.entries[parOffset[par_id] + slot];
+    assert(par_entry.way_index == -1);
+    par_entry.way_index = way_index;
+    par_entry.setPosition(0, way_index);
+    resetParEntry(par_set, par_id, slot);
+    return &par_entry;
+}
+
+void
+Par::resetParEntry(ParSetState& par_set, int par_id, int slot)
+{
+    replPolicy->reset(par_set.entries[parOffset[par_id] + slot].replacementData);
+}
+
+void
+Par::touchParEntry(ParSetState& par_set, int par_id, int slot)
+{
+    replPolicy->touch(par_set.entries[parOffset[par_id] + slot].replacementData);
+}
+
+void
+Par::invalidateParEntry(ParSetState& par_set, int par_id, int slot)
+{
+    replPolicy->invalidate(par_set.entries[parOffset[par_id] + slot].replacementData);
+}
+
+int
+Par::getParVictim(ParSetState& par_set, int par_id,
+                  const ReplacementCandidates& candidates) const
+{
+    // The partition entries are passed as candidates to the implemented replacement policy,
+    // so no temporary entry is created
+    parCandidates.clear();
+    for (auto& candidate : candidates) {
+        if (candidate == nullptr) {
+            continue;
+        }
+        ParEntry* par_entry = get_par_entry(par_set, candidate->getWay(), par_id);
+        if (par_entry != nullptr) {
+            assert(par_entry->getWay() == candidate->getWay());
+            parCandidates.push_back(par_entry);
+        }
+    }
+
+    // partition must be full, a shrunk partition can hold more entries than its size
+    DPRINTFR(RP, "getVictim: current size %d, total size %d\n", parCandidates.size(), par_config[par_id]);
+    assert(parCandidates.size() >= par_config[par_id]);
+    assert(parCandidates.size() > 0);
+    // get the victim in this partition using the implemented replacement policy
+    return replPolicy->getVictim(parCandidates)->getWay();
+}
+
+std::shared_ptr<ReplacementData>
+Par::instantiateParEntry()
+{
+    return replPolicy->instantiateEntry();
 }
 
 void
@@ -45,20 +293,17 @@ Par::invalidate(const std::shared_ptr<ReplacementData>& replacement_data)
     DPRINTFR(RP, "invalidate\n");
     // invalidate an unowned cache entry
     // simply perform sanity check to ensure the entry is unowned
-    std::shared_ptr<ParReplData> par_repl_data = 
-        std::static_pointer_cast<ParReplData>(replacement_data);
-    int way_index = par_repl_data->way_index;
-    std::shared_ptr<ParTable> par_table = par_repl_data->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data->owner_table;
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+    ParSetState& par_set = getParSet(par_repl_data);
     // sanity check: entry must be unowned
-    for (const auto& owner_vec : *owner_table) {
-        assert(!owner_vec[way_index]);
-    }
-    for (const auto& par : *par_table) {
-        for (const auto& par_entry : par) {
-            assert(par_entry.way_index != way_index);
-        }
+    assert(par_set.owners[par_repl_data.way_index] == 0);
+    if (wayMaskMode) {
+        const uint64_t way_bit = 1ULL << par_repl_data.way_index;
+        par_set.allocated &= ~way_bit;
+        par_set.doomed &= ~way_bit;
+        replPolicy->invalidate(par_set.entries[par_repl_data.way_index].replacementData);
     }
+    parStats.m_phy_replacement++;
 }
 
 void
@@ -78,39 +323,68 @@ Par::getVictim(const ReplacementCandidates& candidates) const
 {
     DPRINTFR(RP, "getVictim\n");
 
-    // keep a reference of the replacement data of the first candidate
+    // keep a reference of the partition state of the first candidate
     assert(candidates.size() != 0);
     assert(candidates[0] != nullptr);
-    std::shared_ptr<ParReplData> par_repl_data_0 = 
-        std::static_pointer_cast<ParReplData>(candidates[0]->replacementData);
-    std::shared_ptr<ParTable> par_table = par_repl_data_0->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data_0->owner_table;
-    for (auto& candidate : candidates) {
-        assert(candidate != nullptr);
-        std::shared_ptr<ParReplData> par_repl_data = 
-            std::static_pointer_cast<ParReplData>(candidate->replacementData);
-        // sanity check: all candidates should be in the same set, 
-        // thus sharing the same partition table and owner table
-        assert(par_repl_data->par_table == par_table);
-        assert(par_repl_data->owner_table == owner_table);
-        // also ensure that way number is consistent
-        assert(par_repl_data->way_index == candidate->getWay());
+    ParSetState* par_set = &getParSet(getParReplData(candidates[0]->replacementData));
+
+    if (wayMaskMode) {
+        // Replace a partition victim, one without owners left first
+        ReplaceableEntry* victim = nullptr;
+        for (auto& candidate : candidates) {
+            const int way_index = candidate->getWay();
+            if ((par_set->doomed >> way_index) & 1) {
+                if (par_set->owners[way_index] == 0) {
+                    return candidate;
+                }
+                if (victim == nullptr) {
+                    victim = candidate;
+                }
+            }
+        }
+        // the victim is removed from its owners first (see reclaimPar())
+        assert(victim != nullptr);
+        return victim;
     }
 
     // Return an unowned entry to replace
-    // Such entry is guaranteed to exist when this function is called
+    // Such entry is guaranteed to exist when this function is called, unless the partitions were resized
     // Select the first entry that meets the requirement
     for (auto& candidate : candidates) {
-        std::shared_ptr<ParReplData> par_repl_data = 
-            std::static_pointer_cast<ParReplData>(candidate->replacementData);
-        int way_index = candidate->getWay();
-        std::vector<int> owners = get_owners(owner_table, way_index);
-        if (owners.empty()) {
+        assert(candidate != nullptr);
+        // sanity check: all candidates should be in the same set,
+        // thus sharing the same partition state,
+        // also ensure that way number is consistent
+        assert(&getParSet(getParReplData(candidate->replacementData)) == par_set);
+        assert(getParReplData(candidate->replacementData).way_index == candidate->getWay());
+        if (par_set->owners[candidate->getWay()] == 0) {
             DPRINTFR(RP, "getVictim: found unowned\n");
             return candidate;
         }
     }
 
+    // After a resize, the partitions exceeding their sizes can fill the whole set,
+    // then replace an entry of the partition exceeding its size the most,
+    // the entry must be reclaimed from its owners before being replaced (see reclaimPar())
+    assert(resizable);
+    int reclaim_par_id = -1;
+    int max_excess = 0;
+    for (int i = 0; i < par_config.size(); ++i) {
+        int excess = par_set->occupancy[i] - par_config[i];
+        if (excess > max_excess) {
+            reclaim_par_id = i;
+            max_excess = excess;
+        }
+    }
+    assert(reclaim_par_id != -1);
+    DPRINTFR(RP, "getVictim: no unowned entry, reclaiming from par %d\n", reclaim_par_id);
+    int victim_way = getParVictim(*par_set, reclaim_par_id, candidates);
+    for (auto& candidate : candidates) {
+        if (candidate->getWay() == victim_way) {
+            return candidate;
+        }
+    }
+
     assert(false);  // should never reach here
     return nullptr;
 }
@@ -122,29 +396,36 @@ Par::invalidate(const std::shared_ptr<ReplacementData>& replacement_data, int pa
     // ensure valid partition id
     assert(par_id < par_config.size());
 
-    std::shared_ptr<ParReplData> par_repl_data = 
-        std::static_pointer_cast<ParReplData>(replacement_data);
-    int way_index = par_repl_data->way_index;
-    std::shared_ptr<ParTable> par_table = par_repl_data->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data->owner_table;
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+    int way_index = par_repl_data.way_index;
+    ParSetState& par_set = getParSet(par_repl_data);
+
+    if (wayMaskMode) {
+        // the partition replacing a line does not necessarily own it
+        if (is_owner(par_set, way_index, par_id)) {
+            par_set.owners[way_index] &= ~(1ULL << par_id);
+            par_set.occupancy[par_id]--;
+            parStats.m_par_eviction[par_id]++;
+        }
+        return;
+    }
 
     // sanity check: the cache way must be owned by the partition
-    assert((*owner_table)[par_id][way_index]);
+    assert(is_owner(par_set, way_index, par_id));
+    ParEntry* par_entry = get_par_entry(par_set, way_index, par_id);
+    assert(par_entry != nullptr);
     // remove ownership: 
     // update the owner table
-    (*owner_table)[par_id][way_index] = false;
+    par_set.owners[way_index] &= ~(1ULL << par_id);
     // unlink par entry by setting way index to -1
-    bool found = false;
-    for (ParEntry& par_entry : par_table->at(par_id)) {
-        if (par_entry.way_index == way_index) {
-            par_entry.way_index = -1;
-            // also invalidate partition data
-            replPolicy->invalidate(par_entry.replData);
-            found = true;
-            break;
-        }
-    }
-    assert(found);
+    int slot = par_set.slots[par_id * num_way + way_index];
+    par_set.slots[par_id * num_way + way_index] = -1;
+    par_set.vacant[par_id] |= 1ULL << slot;
+    par_set.occupancy[par_id]--;
+    par_entry->way_index = -1;
+    // also invalidate partition data
+    invalidateParEntry(par_set, par_id, slot);
+    parStats.m_par_eviction[par_id]++;
 }
 
 void
@@ -154,50 +435,59 @@ Par::touch(const std::shared_ptr<ReplacementData>& replacement_data, int par_id)
     // ensure valid partition id
     assert(par_id < par_config.size());
 
-    std::shared_ptr<ParReplData> par_repl_data = 
-        std::static_pointer_cast<ParReplData>(replacement_data);
-    int way_index = par_repl_data->way_index;
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+    int way_index = par_repl_data.way_index;
     DPRINTFR(RP, "touch: way index %d\n", way_index);
-    std::shared_ptr<ParTable> par_table = par_repl_data->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data->owner_table;
+    ParSetState& par_set = getParSet(par_repl_data);
+
+    if (wayMaskMode) {
+        // any partition hits on any line, the replacement state is shared by the set
+        assert((par_set.allocated >> way_index) & 1);
+        if (par_set.sampled) {
+            if (is_owner(par_set, way_index, par_id)) {
+                parStats.m_par_hit[par_id]++;
+            } else {
+                parStats.m_shared_claim[par_id]++;
+            }
+        }
+        addOwner(par_set, way_index, par_id);
+        replPolicy->touch(par_set.entries[way_index].replacementData);
+        if (par_set.sampled) {
+            sampleParSet(par_set);
+        }
+        return;
+    }
 
     // if the cache way already belongs to the partition
     // simply update the underlying replacement data of the implemented replacement policy
-    if ((*owner_table)[par_id][way_index] == true) {
+    ParEntry* par_entry = get_par_entry(par_set, way_index, par_id);
+    if (par_entry != nullptr) {
         DPRINTFR(RP, "touch: address is already in parition\n");
-        std::shared_ptr<ReplacementData> replData = get_replacement_data(par_table, way_index, par_id);
-        assert(replData != nullptr);
-        replPolicy->touch(replData);
+        touchParEntry(par_set, par_id, par_set.slots[par_id * num_way + way_index]);
+        if (par_set.sampled) {
+            parStats.m_par_hit[par_id]++;
+            sampleParSet(par_set);
+        }
         return;
     }
-    
-    // get the number of cache ways belonging to the partition
-    int count = 0;
-    for (auto& par_entry : par_table->at(par_id)) {
-        if (par_entry.way_index != -1) {
-            count++;
+
+    // there must be at least one vacant partition entry
+    assert(par_set.occupancy[par_id] < par_config[par_id]);
+    if (par_set.sampled) {
+        parStats.m_par_miss[par_id]++;
+        if (par_set.owners[way_index] != 0) {
+            parStats.m_shared_claim[par_id]++;
         }
     }
-    assert(count < par_config[par_id]);  // there must be at least one vacant partition entry
 
     // bring the touched entry in the partition
-    (*owner_table)[par_id][way_index] = true;
-    // update par entry
-    bool found = false;
-    for (auto& par_entry : par_table->at(par_id)) {
-        if (par_entry.way_index == -1) {
-            found = true;
-            par_entry.way_index = way_index;
-            replPolicy->reset(par_entry.replData);
-            break;
-        }
-    }
-    assert(found); 
+    par_entry = claim(par_set, way_index, par_id);
 
     // update the underlying replacement data of the implemented replacement policy
-    std::shared_ptr<ReplacementData> replData = get_replacement_data(par_table, way_index, par_id);
-    assert(replData != nullptr);
-    replPolicy->touch(replData);
+    touchParEntry(par_set, par_id, par_entry - &par_set.entries[parOffset[par_id]]);
+    if (par_set.sampled) {
+        sampleParSet(par_set);
+    }
 }
 
 void
@@ -207,35 +497,35 @@ Par::reset(const std::shared_ptr<ReplacementData>& replacement_data, int par_id)
     // ensure valid partition id
     assert(par_id < par_config.size());
 
-    std::shared_ptr<ParReplData> par_repl_data = 
-        std::static_pointer_cast<ParReplData>(replacement_data);
-    int way_index = par_repl_data->way_index;
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+    int way_index = par_repl_data.way_index;
     DPRINTFR(RP, "reset: way index %d\n", way_index);
-    std::shared_ptr<ParTable> par_table = par_repl_data->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data->owner_table;
+    ParSetState& par_set = getParSet(par_repl_data);
 
     // sanity check: the cache way is unowned
-    std::vector<int> owners = get_owners(owner_table, way_index);
-    DPRINTFR(RP, "reset: number of owners %d\n", owners.size());
-    assert(owners.size() == 0);
-    for (const auto& par_entry : par_table->at(par_id)) {
-        assert(par_entry.way_index != way_index);
+    DPRINTFR(RP, "reset: number of owners %d\n",
+        popCount(par_set.owners[way_index]));
+    assert(par_set.owners[way_index] == 0);
+
+    if (wayMaskMode) {
+        assert(!((par_set.allocated >> way_index) & 1));
+        assert((wayMasks[par_id] >> way_index) & 1);
+        par_set.allocated |= 1ULL << way_index;
+        addOwner(par_set, way_index, par_id);
+        replPolicy->reset(par_set.entries[way_index].replacementData);
+        if (par_set.sampled) {
+            parStats.m_par_miss[par_id]++;
+            sampleParSet(par_set);
+        }
+        return;
     }
 
-    // set to be owned
-    // update owner table
-    (*owner_table)[par_id][way_index] = true;
-    // allocate a par entry
-    bool found = false;
-    for (auto& par_entry : par_table->at(par_id)) {
-        if (par_entry.way_index == -1) {
-            par_entry.way_index = way_index;
-            replPolicy->reset(par_entry.replData);
-            found = true;
-            break;
-        }
+    // set to be owned and allocate a par entry
+    claim(par_set, way_index, par_id);
+    if (par_set.sampled) {
+        parStats.m_par_miss[par_id]++;
+        sampleParSet(par_set);
     }
-    assert(found);
 }
 
 /**
@@ -251,41 +541,33 @@ Par::getVictim(const ReplacementCandidates& candidates, int par_id)
     // at least one victim
     assert(candidates.size() != 0);
     
-    // Select a victim among entries that are solely owned by the partition
-    ReplacementCandidates par_candidates;
-    std::shared_ptr<ParTable> par_table;
-    std::shared_ptr<OwnerTable> owner_table;
-    bool found = false;
+    // Select a victim among entries that are owned by the partition
+    ParSetState* par_set = nullptr;
     for (auto& candidate : candidates) {
-        if (candidate == nullptr) {
-            continue;
+        if (candidate != nullptr) {
+            par_set = &getParSet(getParReplData(candidate->replacementData));
+            break;
         }
-        if (!found) {
-            std::shared_ptr<ParReplData> par_repl_data = 
-                std::static_pointer_cast<ParReplData>(candidate->replacementData);
-            owner_table = par_repl_data->owner_table;
-            par_table = par_repl_data->par_table;
-            found = true;
+    }
+    assert(par_set != nullptr);
+    int victim_way;
+    if (wayMaskMode) {
+        // The victim is selected among the lines in the ways of the partition,
+        // it must then be removed from all its owners and physically replaced
+        parCandidates.clear();
+        for (auto& candidate : candidates) {
+            if (candidate != nullptr &&
+                    ((wayMasks[par_id] & par_set->allocated) >> candidate->getWay()) & 1) {
+                parCandidates.push_back(&par_set->entries[candidate->getWay()]);
+            }
         }
-        int way_index = candidate->getWay();
-        if ((*owner_table)[par_id][way_index]) {
-            ReplaceableEntry* par_candidate = new ReplaceableEntry();
-            par_candidate->replacementData = get_replacement_data(par_table, way_index, par_id);
-            assert(par_candidate->replacementData != nullptr);
-            par_candidate->setPosition(0, way_index);
-            par_candidates.push_back(par_candidate);
-        }  
-    }
-
-    // partition must be full
-    DPRINTFR(RP, "getVictim: current size %d, total size %d\n", par_candidates.size(), par_config[par_id]);
-    assert(par_candidates.size() == par_config[par_id]);
-    // get the victim in this partition using the implemented replacement policy
-    int victim_way = replPolicy->getVictim(par_candidates)->getWay();
-    // freeup memory 
-    for (auto& par_candidate : par_candidates) {
-        delete par_candidate;
+        assert(parCandidates.size() > 0);
+        victim_way = replPolicy->getVictim(parCandidates)->getWay();
+        par_set->doomed |= 1ULL << victim_way;
+    } else {
+        victim_way = getParVictim(*par_set, par_id, candidates);
     }
+    parStats.m_par_replacement[par_id]++;
 
     // return victim candidate
     for (auto& candidate : candidates) {
@@ -308,21 +590,20 @@ Par::parAvail(const std::shared_ptr<ReplacementData>& replacement_data, int par_
     DPRINTFR(RP, "parAvail: on parition %d\n", par_id);
     // ensure valid partition id
     assert(par_id < par_config.size());
-    std::shared_ptr<ParReplData> par_repl_data = 
-        std::static_pointer_cast<ParReplData>(replacement_data);
-    std::shared_ptr<ParTable> par_table = par_repl_data->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data->owner_table;
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+
+    if (wayMaskMode) {
+        // a way of the partition is free, or a partition victim is being replaced
+        const ParSetState& par_set = getParSet(par_repl_data);
+        return (wayMasks[par_id] & (~par_set.allocated | par_set.doomed)) != 0;
+    }
     
     // get the number of cache ways belonging to the partition
-    int count = 0;
-    for (auto& par_entry : par_table->at(par_id)) {
-        if (par_entry.way_index != -1) {
-            count++;
-        }
-    }
+    int count = getParSet(par_repl_data).occupancy[par_id];
     DPRINTFR(RP, "parAvail: current size %d, total size %d\n", count, par_config[par_id]);
 
-    assert(count <= par_config[par_id]);
+    // a shrunk partition can hold more entries than its size
+    assert(resizable || count <= par_config[par_id]);
     // return if the partition has a free entry
     return count < par_config[par_id];
 }
@@ -332,17 +613,74 @@ Par::parHit(const std::shared_ptr<ReplacementData>& replacement_data, int par_id
 {
     // ensure valid partition id
     assert(par_id < par_config.size());
-    std::shared_ptr<ParReplData> par_repl_data = 
-        std::static_pointer_cast<ParReplData>(replacement_data);
-    int way_index = par_repl_data->way_index;
-    std::shared_ptr<ParTable> par_table = par_repl_data->par_table;
-    std::shared_ptr<OwnerTable> owner_table = par_repl_data->owner_table;
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+
+    // in way-mask mode, any line of the set is a hit
+    if (wayMaskMode) {
+        return (getParSet(par_repl_data).allocated >> par_repl_data.way_index) & 1;
+    }
 
     // if the cache way belongs to the partition, return true
-    if ((*owner_table)[par_id][way_index] == true) {
-        return true;
-    } else {
-        return false;
+    return is_owner(getParSet(par_repl_data), par_repl_data.way_index, par_id);
+}
+
+int
+Par::reclaimPar(const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+    const ParSetState& par_set = getParSet(par_repl_data);
+
+    if (wayMaskMode) {
+        // remove a partition victim from its owners one by one
+        const uint64_t owners = par_set.owners[par_repl_data.way_index];
+        return owners == 0 ? -1 : ctz64(owners);
+    }
+
+    int reclaim_par_id = -1;
+    int max_excess = 0;
+    for (uint64_t owners = par_set.owners[par_repl_data.way_index];
+            owners; owners &= owners - 1) {
+        int par_id = ctz64(owners);
+        int excess = par_set.occupancy[par_id] - par_config[par_id];
+        if (reclaim_par_id == -1 || excess > max_excess) {
+            reclaim_par_id = par_id;
+            max_excess = excess;
+        }
+    }
+    return reclaim_par_id;
+}
+
+bool
+Par::parAllowed(const std::shared_ptr<ReplacementData>& replacement_data, int par_id) const
+{
+    assert(par_id < par_config.size());
+    return !wayMaskMode ||
+        ((wayMasks[par_id] >> getParReplData(replacement_data).way_index) & 1);
+}
+
+bool
+Par::phyAvail(const std::shared_ptr<ReplacementData>& replacement_data) const
+{
+    return !wayMaskMode || getParSet(getParReplData(replacement_data)).doomed == 0;
+}
+
+void
+Par::addOwner(ParSetState& par_set, int way_index, int par_id)
+{
+    if (!is_owner(par_set, way_index, par_id)) {
+        par_set.owners[way_index] |= 1ULL << par_id;
+        par_set.occupancy[par_id]++;
+    }
+}
+
+void
+Par::release(const std::shared_ptr<ReplacementData>& replacement_data)
+{
+    const ParReplData& par_repl_data = getParReplData(replacement_data);
+    // iterate over a copy, the owner word is updated by each invalidation
+    for (uint64_t owners = getParSet(par_repl_data).owners[par_repl_data.way_index];
+            owners; owners &= owners - 1) {
+        invalidate(replacement_data, ctz64(owners));
     }
 }
 
@@ -352,36 +690,40 @@ Par::instantiateEntry()
     // Note: the logic expects the instantiateEntry() is called 
     // in the sequence that creates entries within a cache set first.
     // e.g. see logic in ruby CacheMemory.
-    int way_index = m_count % num_way;
-    // DPRINTFR(RP, "instantiateEntry: way index %d\n", way_index);
+    const uint32_t set_index = m_count / num_way;
+    const int way_index = m_count % num_way;
     if (way_index == 0) {
-        // create new partition table
-        parTableInstance = new ParTable();
-        for (int par_size : par_config) {
-            std::vector<ParEntry> partitions;
-            for (int i = 0; i < par_size; ++i) {
-                std::shared_ptr<ReplacementData> repl_data = replPolicy->instantiateEntry();
-                partitions.push_back({-1, repl_data});  // use -1 way index to indicate this entry is empty
-            }
-            parTableInstance->push_back(partitions);
-        }
-
-        // create new owner table
-        ownerTableInstance = new OwnerTable();
+        // create new partition state
         int par_num = par_config.size();
-        for (int i = 0; i < par_num; ++i) {
-            ownerTableInstance->push_back(std::vector<bool>(num_way, false));
+        ParSetState& par_set = parSets.emplace_back();
+        par_set.owners.assign(num_way, 0);
+        par_set.occupancy.assign(par_num, 0);
+        if (wayMaskMode) {
+            // one entry per cache way, holding the replacement data shared by all partitions
+            par_set.entries.reserve(num_way);
+            for (int i = 0; i < num_way; ++i) {
+                ParEntry& par_entry = par_set.entries.emplace_back(instantiateParEntry());
+                par_entry.way_index = i;
+                par_entry.setPosition(0, i);
+            }
+        } else {
+            par_set.slots.assign(par_num * num_way, -1);
+            par_set.entries.reserve(parOffset.back() + parCapacity.back());
+            for (int par_capacity : parCapacity) {
+                par_set.vacant.push_back(
+                    par_capacity == 64 ? ~0ULL : (1ULL << par_capacity) - 1);
+                for (int i = 0; i < par_capacity; ++i) {
+                    par_set.entries.emplace_back(instantiateParEntry());
+                }
+            }
         }
+        instantiateParSet(par_set);
+        par_set.sampled = set_index % statsSamplingInterval == 0;
     }
-    
+    assert(set_index == parSets.size() - 1);
+
     m_count++;  // increment counter
-    std::shared_ptr<ReplacementData> repl_data = replPolicy->instantiateEntry();
-    ParReplData* par_repl_data = new ParReplData(
-        std::shared_ptr<ParTable>(parTableInstance),
-        std::shared_ptr<OwnerTable>(ownerTableInstance),
-        way_index);
-    // DPRINTFR(RP, "instantiateEntry: way index %d\n", par_repl_data->way_index);
-    return std::shared_ptr<ReplacementData>(par_repl_data);
+    return std::make_shared<ParReplData>(set_index, way_index);
 }
 
 } // namespace replacement_policy
@@ -5,6 +5,7 @@
 #ifndef __MEM_CACHE_REPLACEMENT_POLICIES_PAR_RP_HH__
 #define __MEM_CACHE_REPLACEMENT_POLICIES_PAR_RP_HH__
 
+#include "base/statistics.hh"
 #include "mem/cache/replacement_policies/base.hh"
 #include <set>
 
@@ -17,55 +18,108 @@ GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
 namespace replacement_policy
 {
 
+class ParUtilityMonitor;
+
 /**
  * This replacement policy is a partitioned implementation of a specific replacement policy.
  * For example, if the implemented policy is LRU, and there are two cores sharing a cache set,
  * each core maintains its own LRU state over its assigned partition.
+ *
+ * With way masks (way_masks parameter), the policy instead models way-mask partitioning
+ * as in Intel CAT: any partition hits on any line of the set, but a partition only allocates
+ * (and replaces) lines in the ways of its mask, with one replacement state shared by the set.
+ * Masks can overlap and are changed at runtime with setWayMask().
+ * The owner word of a way then tracks the partitions that accessed the line,
+ * so that all of them are removed (back invalidated) before the line is replaced.
  */
 class Par : public Base
 { 
     protected:
 
-        struct ParEntry {
+        /**
+         * A partition entry is itself a replaceable entry, whose replacement data is
+         * the replacement data of the implemented replacement policy and whose way
+         * is the cache way it points to. The entries of a partition are thus handed
+         * directly to the implemented policy as victim candidates.
+         */
+        struct ParEntry : ReplaceableEntry {
             int way_index;  // cache way number that this replacement data entry points to
-            std::shared_ptr<ReplacementData> replData; // replacement data of implemented replacement policy
+
+            ParEntry(const std::shared_ptr<ReplacementData>& repl_data)
+            : ReplaceableEntry(), way_index(-1)  // use -1 way index to indicate this entry is empty
+            {
+                replacementData = repl_data;
+                setPosition(0, 0);
+            }
         };
 
         /**
-         * Partition Table:
-         * The primary index is the partition id (i.e. owner id).
-         * The secondary index is the entry index within a partition.
-         * Each entry is of type ParEntry.
-         * A ParEntry holds the replacement data of the implemented replacement policy for its partition.
-         * Each ParEntry is associated with a cache way.
+         * Partition state of a cache set, kept in flat arrays.
+         *
+         * The partition table is flattened into a single array of ParEntry.
+         * Partition p holds the entries [parOffset[p], parOffset[p] + parCapacity[p]).
+         * Each ParEntry holds the replacement data of the implemented replacement policy for its partition.
+         * Each ParEntry is associated with a cache way, and its position is set to that way when it is claimed.
          * Multiple ParEntry from different partitions can share (i.e. own) a cache way.
-         * Basically, these ParEntry share the same data stored in the cache way 
+         * Basically, these ParEntry share the same data stored in the cache way
          * but keep disctinct copy of replacement data for its partition.
+         *
+         * Ownership is kept as one owner word per cache way, with one bit per partition,
+         * so that ownership queries and partition occupancy are O(1).
          */
-        typedef std::vector<std::vector<ParEntry>> ParTable;
+        struct ParSetState {
+            /**
+             * Owner word of each cache way.
+             * Bit p is set if the way is owned by partition p.
+             */
+            std::vector<uint64_t> owners;
 
-        /**
-         * Owner Table:
-         * The primary index is the parition id (i.e. owner id).
-         * The secondary index is the cache way number in a cache set.
-         * The value is a boolean identifying if this cache way is owned by a partition.
-         * Dimension: #paritions x #ways
-         */
-        typedef std::vector<std::vector<bool>> OwnerTable;
+            /** Number of cache ways currently held by each partition. */
+            std::vector<int> occupancy;
+
+            /** Bitmask of vacant entries of each partition, relative to its offset. */
+            std::vector<uint64_t> vacant;
+
+            /**
+             * Entry held by a partition for a cache way, relative to the partition offset.
+             * Indexed by (par_id * num_way + way_index), -1 if the way is not owned.
+             */
+            std::vector<int8_t> slots;
+
+            /** Flattened partition table. */
+            std::vector<ParEntry> entries;
+
+            /**
+             * Replacement state kept inline in the set by native partitioned policies
+             * (see par_native_rp.hh). Empty when a replacement policy is wrapped.
+             */
+            std::vector<uint64_t> native;
+
+            /** True if the set updates the per-set statistics (see statsSamplingInterval). */
+            bool sampled;
+
+            /** Way-mask mode: bitmask of the ways holding a cache line. */
+            uint64_t allocated = 0;
+
+            /**
+             * Way-mask mode: bitmask of the ways selected as partition victims.
+             * They must be removed from all their owners, then physically replaced,
+             * before a new line is allocated in the set.
+             */
+            uint64_t doomed = 0;
+        };
 
         /** Par-specific implementation of ReplacementData required in the base class prototype **/
         struct ParReplData : ReplacementData
         {
-            std::shared_ptr<ParTable> par_table;  // pointer to the partition table shared in a cache set
-            std::shared_ptr<OwnerTable> owner_table;  // pointer to the owner table shared in a cache set
-            int way_index;  // the way number of the cache entry associated with this replacement data
-            
+            const uint32_t set_index;  // index of the partition state of the cache set in the policy
+            const int way_index;  // the way number of the cache entry associated with this replacement data
+
             /**
              * Default constructor.
              */
-            ParReplData(const std::shared_ptr<ParTable>& par_table, 
-            const std::shared_ptr<OwnerTable>& owner_table, const int way_index) 
-            : ReplacementData(), par_table(par_table), owner_table(owner_table), way_index(way_index)
+            ParReplData(const uint32_t set_index, const int way_index)
+            : ReplacementData(), set_index(set_index), way_index(way_index)
             {
             }
         };
@@ -73,49 +127,172 @@ class Par : public Base
         Base* const replPolicy;  // implemented replacement policy
         std::vector<int> par_config;
         int num_way;
-        
+
+        /**
+         * True if the partitions can be resized at runtime.
+         * Each partition then reserves one entry per cache way in every set,
+         * so that it can grow up to the whole set without moving entries.
+         */
+        const bool resizable;
+
+        /** Number of entries reserved for each partition in the flattened partition table. */
+        std::vector<int> parCapacity;
+
+        /** Offset of the first entry of each partition in the flattened partition table. */
+        std::vector<int> parOffset;
+
+        /**
+         * True in way-mask mode. The per-set entries then hold one replacement data per
+         * cache way instead of the partition tables.
+         */
+        const bool wayMaskMode;
+
+        /** Way-mask mode: ways each partition can allocate in. */
+        std::vector<uint64_t> wayMasks;
+
+        /** Utility monitor sizing the partitions, nullptr if the sizes are set by hand. */
+        ParUtilityMonitor* const utilityMonitor;
+
+        /**
+         * Only one cache set out of statsSamplingInterval updates the per-set statistics
+         * (hits, misses, occupancy and sharing), so that they stay cheap on large caches.
+         */
+        const unsigned statsSamplingInterval;
+
     private:
         /**
          * Instance counter of replacement data.
-         * It is used to setup the entry vector shared by all cache entries in a cache set.
+         * It gives the cache set and way of each new replacement data entry.
          */
         uint64_t m_count;
 
         /**
-         * Holds the latest temporary ParTable instance created by instantiateEntry().
+         * Partition state of every cache set, indexed by set.
+         * The policy owns the state, the replacement data of a cache entry only holds its set index.
+         * Like the replacement data, it is updated through the const replacement interface.
          */
-        ParTable* parTableInstance;
+        mutable std::vector<ParSetState> parSets;
+
+        static const ParReplData&
+        getParReplData(const std::shared_ptr<ReplacementData>& replacement_data)
+        {
+            return static_cast<const ParReplData&>(*replacement_data);
+        }
+
+        /** Get the partition state of the cache set of an entry. */
+        ParSetState&
+        getParSet(const ParReplData& par_repl_data) const
+        {
+            return parSets[par_repl_data.set_index];
+        }
 
         /**
-         * Holds the latest temporary OwnerTable instance created by instantiateEntry().
+         * Scratch list of partition victim candidates, reused across calls to
+         * getVictim() so that selecting a victim does not allocate.
          */
-        OwnerTable* ownerTableInstance;
+        mutable ReplacementCandidates parCandidates;
 
-        static std::shared_ptr<ReplacementData> get_replacement_data(
-            std::shared_ptr<ParTable> par_table, int way_index, int par_id) 
+        /**
+         * Get the partition entry that holds a cache way, nullptr if the way
+         * is not owned by the partition.
+         */
+        ParEntry*
+        get_par_entry(ParSetState& par_set, int way_index, int par_id) const
         {
-            for (ParEntry& par_entry : par_table->at(par_id)) {
-                if (par_entry.way_index == way_index) {
-                    return par_entry.replData;
-                }
+            int slot = par_set.slots[par_id * num_way + way_index];
+            if (slot < 0) {
+                return nullptr;
             }
-            return nullptr;
+            return &par_set.entries[parOffset[par_id] + slot];
         }
 
-        static std::vector<int> get_owners(std::shared_ptr<OwnerTable> owner_table, int way_index) {
-            std::vector<int> owners;
-            for (int i = 0; i < owner_table->size(); i++) {
-                if ((*owner_table)[i][way_index] == true) {
-                    owners.push_back(i);
-                }
-            }
-            return owners;
+        /**
+         * Return true if the cache way is owned by the partition.
+         */
+        static bool
+        is_owner(const ParSetState& par_set, int way_index, int par_id)
+        {
+            return (par_set.owners[way_index] >> par_id) & 1;
         }
 
+        /**
+         * Bring a cache way into a vacant entry of the partition and reset
+         * the replacement data of that entry.
+         *
+         * @return The partition entry now holding the cache way.
+         */
+        ParEntry* claim(ParSetState& par_set, int way_index, int par_id);
+
+        /** Way-mask mode: add a partition to the owners of a cache way. */
+        void addOwner(ParSetState& par_set, int way_index, int par_id);
+
+        /** Way-mask mode: check a way mask and return its number of ways. */
+        int checkWayMask(uint64_t way_mask) const;
+
+        /** Sample the occupancy and sharing of a cache set. */
+        void sampleParSet(const ParSetState& par_set);
+
+        struct ParStats : public statistics::Group
+        {
+            ParStats(Par &parent);
+
+            statistics::Vector m_par_hit;
+            statistics::Vector m_par_miss;
+            statistics::Vector m_shared_claim;
+            statistics::VectorDistribution m_occupancy;
+            statistics::Distribution m_shared_ways;
+            statistics::Vector m_par_replacement;
+            statistics::Vector m_par_eviction;
+            statistics::Scalar m_phy_replacement;
+        } parStats;
+
+        /**
+         * All the resizable partitioned replacement policies in the system,
+         * used to resize the partitions from the simulated program.
+         */
+        static std::vector<Par*> instances;
+
+    protected:
+        /**
+         * Constructor used by the native partitioned policies, which keep their
+         * replacement state in the set and do not wrap a replacement policy.
+         *
+         * @param wrap_policy True if a replacement policy is wrapped.
+         */
+        Par(const ParRPParams &p, bool wrap_policy);
+
+        /**
+         * Replacement state operations on a single partition entry.
+         * The entry is identified by its partition and its index in the partition.
+         * By default they forward to the implemented replacement policy.
+         */
+        virtual void resetParEntry(ParSetState& par_set, int par_id, int slot);
+        virtual void touchParEntry(ParSetState& par_set, int par_id, int slot);
+        virtual void invalidateParEntry(ParSetState& par_set, int par_id, int slot);
+
+        /**
+         * Select the victim among the entries of a full (or shrunk) partition.
+         *
+         * @param candidates Replacement candidates of the cache set.
+         * @return The cache way to be removed from the partition.
+         */
+        virtual int getParVictim(ParSetState& par_set, int par_id,
+                                 const ReplacementCandidates& candidates) const;
+
+        /**
+         * Instantiate the replacement data of a partition entry.
+         */
+        virtual std::shared_ptr<ReplacementData> instantiateParEntry();
+
+        /**
+         * Initialize the per-set state beyond the partition table, called once per cache set.
+         */
+        virtual void instantiateParSet(ParSetState& par_set) {}
+
     public:
         typedef ParRPParams Params;
         Par(const Params &p);
-        ~Par() = default;
+        ~Par();
 
         /**
          * Invalidate replacement data to set it as the next probable victim.
@@ -172,12 +349,83 @@ class Par : public Base
          */
         bool parHit(const std::shared_ptr<ReplacementData>& replacement_data, int par_id);
 
+        /**
+         * Return true if the partition can allocate a line in the cache way of the entry,
+         * i.e. the way is in its mask in way-mask mode. Always true otherwise.
+         */
+        bool parAllowed(const std::shared_ptr<ReplacementData>& replacement_data,
+                        int par_id) const;
+
+        /**
+         * Return true if a line can be allocated in the cache set of the entry without
+         * replacing a line first. It is false in way-mask mode while partition victims
+         * wait to be replaced. Always true otherwise.
+         */
+        bool phyAvail(const std::shared_ptr<ReplacementData>& replacement_data) const;
+
+        /**
+         * Return the partition an entry must be removed from before it can be replaced,
+         * i.e. its owner that exceeds its size the most, -1 if the entry is unowned.
+         * Only resizable partitions can fill a cache set with owned entries,
+         * in which case getVictim() returns an entry of the partition that exceeds its size the most.
+         */
+        int reclaimPar(const std::shared_ptr<ReplacementData>& replacement_data) const;
+
+        /**
+         * Remove an entry from every partition owning it, e.g. before it is invalidated
+         * by a cache that does not go through the partition replacements (classic caches).
+         */
+        void release(const std::shared_ptr<ReplacementData>& replacement_data);
+
+        /**
+         * Get the number of partitions.
+         */
+        int getNumPar() const { return par_config.size(); }
+
         /**
          * Instantiate a replacement data entry.
          *
          * @return A shared pointer to the new replacement data.
          */
         std::shared_ptr<ReplacementData> instantiateEntry() override;
+
+        /**
+         * Resize the partitions at runtime.
+         * The new sizes must sum up to the number of ways.
+         * A grown partition can claim new ways right away.
+         * A shrunk partition keeps its excess ways until they are removed one by one
+         * by the partition replacements of its next misses (i.e. Par_Replacement in the LLC protocol).
+         *
+         * @param new_par_config New size of each partition.
+         */
+        void resize(const std::vector<int>& new_par_config);
+
+        /**
+         * Move ways from a partition to another.
+         */
+        void moveWays(int src_par_id, int dst_par_id, int num_ways);
+
+        /**
+         * Move ways from a partition to another in all the resizable
+         * partitioned replacement policies of the system.
+         * Used by the m5 op and the omptr marker.
+         */
+        static void moveWaysAll(int src_par_id, int dst_par_id, int num_ways);
+
+        /**
+         * Way-mask mode: change the ways a partition can allocate in.
+         * Lines outside the new mask stay until they are replaced.
+         */
+        void setWayMask(int par_id, uint64_t way_mask);
+
+        /** Return true in way-mask mode. */
+        bool isWayMaskMode() const { return wayMaskMode; }
+
+        /**
+         * Get the utility monitor sizing the partitions, nullptr if none.
+         * The cache must report the accesses of each partition to it.
+         */
+        ParUtilityMonitor* getUtilityMonitor() const { return utilityMonitor; }
 };
 
 } // namespace replacement_policy
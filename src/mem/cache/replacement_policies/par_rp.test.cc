@@ -0,0 +1,342 @@
+/**
+ * @file
+ * Unit tests of the partitioned replacement policies.
+ * The policies are driven directly on a few cache sets, the way the LLC protocol
+ * drives them: a partition replacement first makes room in a full partition,
+ * then an unowned way is physically replaced.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "base/bitfield.hh"
+#include "mem/cache/replacement_policies/fifo_rp.hh"
+#include "mem/cache/replacement_policies/lru_rp.hh"
+#include "mem/cache/replacement_policies/par_native_rp.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
+#include "mem/cache/replacement_policies/tree_plru_rp.hh"
+#include "params/FIFORP.hh"
+#include "params/LRURP.hh"
+#include "params/ParFIFORP.hh"
+#include "params/ParLRURP.hh"
+#include "params/ParRP.hh"
+#include "params/TreePLRURP.hh"
+#include "sim/root.hh"
+
+using namespace gem5;
+
+// Instantiate the fake class to have a valid curTick of 0
+GTestTickHandler tickHandler;
+
+// The statistics are never resolved by name, there is no Root
+Root *Root::_root = nullptr;
+
+namespace
+{
+
+const uint64_t invalidTag = ~0ULL;
+
+/** Build the parameters of a partitioned replacement policy. */
+template <class Params>
+Params
+parParams(const std::string &name, const std::vector<int> &par_config,
+          bool resizable, replacement_policy::Base *repl_policy)
+{
+    Params p;
+    p.name = name;
+    p.eventq_index = 0;
+    p.replacement_policy = repl_policy;
+    p.par_config = par_config;
+    p.num_way = 0;
+    for (int par_size : par_config) {
+        p.num_way += par_size;
+    }
+    p.resizable = resizable;
+    p.utility_monitor = nullptr;
+    p.stats_sampling_interval = 1;
+    return p;
+}
+
+/**
+ * A cache set holding one tag per way, whose replacements are selected by a
+ * partitioned replacement policy.
+ */
+class ParSet
+{
+  public:
+    /**
+     * Ways replaced by an access: the partition victims, then the physical victim.
+     * A shrunk partition replaces one entry per access until it fits its new size.
+     */
+    typedef std::vector<int> Victims;
+
+    ParSet(replacement_policy::Par &rp, int num_way)
+      : rp(rp), entries(num_way), tags(num_way, invalidTag)
+    {
+        // the policy expects the entries of a set to be instantiated together
+        for (int i = 0; i < num_way; ++i) {
+            entries[i].replacementData = rp.instantiateEntry();
+            entries[i].setPosition(0, i);
+            candidates.push_back(&entries[i]);
+        }
+    }
+
+    /** Access a line from a partition, bringing it in the partition on a miss. */
+    Victims
+    access(uint64_t tag, int par_id)
+    {
+        Victims victims;
+        int way = find(tag);
+        if (way != -1) {
+            const auto &repl_data = entries[way].replacementData;
+            // as the protocol, retry the access after each partition replacement
+            while (!rp.parHit(repl_data, par_id) && !rp.parAvail(repl_data, par_id)) {
+                victims.push_back(parReplace(par_id));
+            }
+            rp.touch(repl_data, par_id);
+            return victims;
+        }
+
+        while (!rp.parAvail(entries[0].replacementData, par_id)) {
+            victims.push_back(parReplace(par_id));
+        }
+        // the partition victim stays in the set while other partitions own it
+        way = rp.getVictim(candidates)->getWay();
+        const auto &repl_data = entries[way].replacementData;
+        // after a resize the victim can still be owned by shrunk partitions
+        for (int owner = rp.reclaimPar(repl_data); owner != -1;
+                owner = rp.reclaimPar(repl_data)) {
+            rp.invalidate(repl_data, owner);
+        }
+        if (tags[way] != invalidTag) {
+            rp.invalidate(repl_data);
+        }
+        victims.push_back(way);
+        tags[way] = tag;
+        rp.reset(repl_data, par_id);
+        return victims;
+    }
+
+    /** Invalidate a line from all its owners, e.g. on a writeback from another level. */
+    void
+    invalidate(uint64_t tag)
+    {
+        int way = find(tag);
+        if (way == -1) {
+            return;
+        }
+        rp.release(entries[way].replacementData);
+        rp.invalidate(entries[way].replacementData);
+        tags[way] = invalidTag;
+    }
+
+  private:
+    replacement_policy::Par &rp;
+    std::vector<ReplaceableEntry> entries;
+    ReplacementCandidates candidates;
+    std::vector<uint64_t> tags;
+
+    int
+    find(uint64_t tag) const
+    {
+        for (int i = 0; i < tags.size(); ++i) {
+            if (tags[i] == tag) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /** Remove the partition victim from a full partition. */
+    int
+    parReplace(int par_id)
+    {
+        int way = rp.getVictim(candidates, par_id)->getWay();
+        rp.invalidate(entries[way].replacementData, par_id);
+        return way;
+    }
+};
+
+/**
+ * Replay a random sequence of accesses and invalidations from all the
+ * partitions on a set of the policy, and return the ways it replaced.
+ * Lines are shared between partitions, and pairs of operations share a tick
+ * so that ties between equally old entries are exercised.
+ * A resizable policy has its partition sizes reversed halfway.
+ */
+std::vector<ParSet::Victims>
+replay(replacement_policy::Par &rp, const std::vector<int> &par_config, bool resizable)
+{
+    const int num_ops = 20000;
+    int num_way = 0;
+    for (int par_size : par_config) {
+        num_way += par_size;
+    }
+
+    ParSet set(rp, num_way);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<uint64_t> tag_dist(0, 3 * num_way - 1);
+    std::uniform_int_distribution<int> par_dist(0, par_config.size() - 1);
+    std::uniform_int_distribution<int> op_dist(0, 15);
+
+    std::vector<ParSet::Victims> victims;
+    for (int i = 0; i < num_ops; ++i) {
+        tickHandler.setCurTick(i / 2 + 1);
+        if (resizable && i == num_ops / 2) {
+            rp.resize(std::vector<int>(par_config.rbegin(), par_config.rend()));
+        }
+        const uint64_t tag = tag_dist(rng);
+        const int par_id = par_dist(rng);
+        if (op_dist(rng) == 0) {
+            set.invalidate(tag);
+        } else {
+            victims.push_back(set.access(tag, par_id));
+        }
+    }
+    return victims;
+}
+
+/**
+ * Check that a native partitioned policy replaces the same ways as ParRP
+ * wrapping the corresponding replacement policy.
+ */
+template <class Native, class Wrapped>
+void
+checkSameVictims(const std::vector<int> &par_config, bool resizable)
+{
+    typename Wrapped::Params wrapped_params;
+    wrapped_params.name = "wrapped";
+    wrapped_params.eventq_index = 0;
+    Wrapped wrapped(wrapped_params);
+    ParRPParams par_params = parParams<ParRPParams>(
+        "par", par_config, resizable, &wrapped);
+    replacement_policy::Par par(par_params);
+
+    typename Native::Params native_params =
+        parParams<typename Native::Params>("native", par_config, resizable, nullptr);
+    Native native(native_params);
+
+    std::vector<ParSet::Victims> expected = replay(par, par_config, resizable);
+    std::vector<ParSet::Victims> victims = replay(native, par_config, resizable);
+    ASSERT_EQ(victims.size(), expected.size());
+    for (int i = 0; i < victims.size(); ++i) {
+        ASSERT_EQ(victims[i], expected[i]) << "access " << i;
+    }
+}
+
+} // anonymous namespace
+
+TEST(ParRPTest, NativeLRUMatchesWrappedLRU)
+{
+    checkSameVictims<replacement_policy::ParLRU, replacement_policy::LRU>(
+        {3, 2, 2, 1}, false);
+    checkSameVictims<replacement_policy::ParLRU, replacement_policy::LRU>(
+        {8, 4, 2, 1, 1}, true);
+}
+
+TEST(ParRPTest, NativeFIFOMatchesWrappedFIFO)
+{
+    checkSameVictims<replacement_policy::ParFIFO, replacement_policy::FIFO>(
+        {3, 2, 2, 1}, false);
+    checkSameVictims<replacement_policy::ParFIFO, replacement_policy::FIFO>(
+        {8, 4, 2, 1, 1}, true);
+}
+
+/**
+ * Moving ways from the simulated program resizes the resizable policies
+ * alive at that time and leaves the other ones alone.
+ */
+TEST(ParRPTest, MoveWaysAllResizesResizablePolicies)
+{
+    const std::vector<int> par_config = {2, 2};
+    LRURPParams lru_params;
+    lru_params.name = "lru";
+    lru_params.eventq_index = 0;
+    replacement_policy::LRU lru(lru_params);
+
+    ParRPParams fixed_params = parParams<ParRPParams>(
+        "fixed", par_config, false, &lru);
+    replacement_policy::Par fixed(fixed_params);
+    ParRPParams resizable_params = parParams<ParRPParams>(
+        "resizable", par_config, true, &lru);
+    replacement_policy::Par resizable(resizable_params);
+    {
+        // a destroyed policy is no longer resized
+        ParRPParams destroyed_params = parParams<ParRPParams>(
+            "destroyed", par_config, true, &lru);
+        replacement_policy::Par destroyed(destroyed_params);
+    }
+
+    replacement_policy::Par::moveWaysAll(0, 1, 1);
+
+    // partition 1 brings 3 lines in without a partition replacement
+    ParSet resizable_set(resizable, 4);
+    for (uint64_t tag = 0; tag < 3; ++tag) {
+        tickHandler.setCurTick(curTick() + 1);
+        EXPECT_EQ(resizable_set.access(tag, 1).size(), 1) << "tag " << tag;
+    }
+    // partition 1 of the fixed policy still holds 2 lines
+    ParSet fixed_set(fixed, 4);
+    for (uint64_t tag = 0; tag < 3; ++tag) {
+        tickHandler.setCurTick(curTick() + 1);
+        EXPECT_EQ(fixed_set.access(tag, 1).size(), tag < 2 ? 1 : 2) << "tag " << tag;
+    }
+}
+
+/**
+ * ParRP wrapping TreePLRURP is not a reference for ParTreePLRU: its trees span
+ * the entries of several partitions, and it orders the candidates by way.
+ * The kernel of ParTreePLRU is instead compared against TreePLRURP managing
+ * a single full partition, whose leaves are the partition slots.
+ */
+TEST(ParRPTest, TreePLRUKernelMatchesTreePLRU)
+{
+    for (int par_size : {2, 4, 8, 16}) {
+        TreePLRURPParams params;
+        params.name = "tree_plru";
+        params.eventq_index = 0;
+        params.num_leaves = par_size;
+        replacement_policy::TreePLRU tree_plru(params);
+
+        std::vector<ReplaceableEntry> entries(par_size);
+        ReplacementCandidates candidates;
+        for (int i = 0; i < par_size; ++i) {
+            entries[i].replacementData = tree_plru.instantiateEntry();
+            entries[i].setPosition(0, i);
+            candidates.push_back(&entries[i]);
+        }
+
+        // the tree kernel does not look at the entries
+        struct { int way_index; } slots[16];
+        uint64_t state = 0;
+        const uint64_t occupied = mask(par_size);
+
+        std::mt19937 rng(par_size);
+        std::uniform_int_distribution<int> slot_dist(0, par_size - 1);
+        std::uniform_int_distribution<int> op_dist(0, 7);
+        for (int i = 0; i < 10000; ++i) {
+            const int slot = slot_dist(rng);
+            const auto &repl_data = entries[slot].replacementData;
+            switch (op_dist(rng)) {
+              case 0:
+                tree_plru.invalidate(repl_data);
+                replacement_policy::ParTreePLRUKernel::invalidate(&state, par_size, slot);
+                break;
+              case 1:
+                tree_plru.reset(repl_data);
+                replacement_policy::ParTreePLRUKernel::reset(&state, par_size, slot);
+                break;
+              default:
+                tree_plru.touch(repl_data);
+                replacement_policy::ParTreePLRUKernel::touch(&state, par_size, slot);
+                break;
+            }
+            ASSERT_EQ(replacement_policy::ParTreePLRUKernel::getVictim(
+                          &state, slots, par_size, occupied),
+                      tree_plru.getVictim(candidates)->getWay()) << "op " << i;
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/**
+ * @file
+ * Micro-benchmark of the partition victim selection of the partitioned
+ * replacement policies, i.e. the cost added to every simulated LLC miss
+ * that replaces an entry of a full partition.
+ *
+ * The reference is the former selection, which allocated a replaceable
+ * entry per way of the partition on every call to gather the candidates
+ * of the wrapped policy. It is compared against ParRP wrapping LRURP and
+ * against the native ParLRURP, on 32-way sets split in 8 full partitions.
+ */
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "mem/cache/replacement_policies/lru_rp.hh"
+#include "mem/cache/replacement_policies/par_native_rp.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
+#include "params/LRURP.hh"
+#include "params/ParLRURP.hh"
+#include "params/ParRP.hh"
+#include "sim/cur_tick.hh"
+#include "sim/root.hh"
+
+using namespace gem5;
+
+// The statistics are never resolved by name, there is no Root
+Root *Root::_root = nullptr;
+
+namespace
+{
+
+const int numSets = 64;
+const int parSize = 4;
+const int numPar = 8;
+const int numWay = parSize * numPar;
+const int numSelections = 1 << 22;
+
+Tick tick = 0;
+
+/**
+ * Sum of the ways selected by a timed loop. The partition entries are reset
+ * in way order and never touched, so every policy selects the same ways.
+ */
+uint64_t victimWay = 0;
+
+/** Partition and set of each selection, the same for every policy. */
+struct Selection
+{
+    int set;
+    int par_id;
+};
+
+std::vector<Selection>
+makeSelections()
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> set_dist(0, numSets - 1);
+    std::uniform_int_distribution<int> par_dist(0, numPar - 1);
+    std::vector<Selection> selections(numSelections);
+    for (Selection &s : selections) {
+        s.set = set_dist(rng);
+        s.par_id = par_dist(rng);
+    }
+    return selections;
+}
+
+/** Report the host time per selection of a timed loop. */
+template <class Loop>
+double
+timeSelections(const char *name, Loop loop)
+{
+    victimWay = 0;
+    auto start = std::chrono::steady_clock::now();
+    loop();
+    auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(
+        end - start).count() / numSelections;
+    ccprintf(std::cout, "%-40s %8.1f ns/selection\n", name, ns);
+    return ns;
+}
+
+/**
+ * The former selection: the owner table of the set is looked up for every
+ * way, and the owned ways are copied in replaceable entries allocated for the
+ * call, handed to the wrapped policy, then freed.
+ */
+double
+benchAllocatingSelection(const std::vector<Selection> &selections)
+{
+    LRURPParams lru_params;
+    lru_params.name = "lru";
+    lru_params.eventq_index = 0;
+    replacement_policy::LRU lru(lru_params);
+
+    // per set, the ways owned by each partition and the entries of each partition
+    struct ParEntry
+    {
+        int way_index;
+        std::shared_ptr<replacement_policy::ReplacementData> repl_data;
+    };
+    std::vector<std::vector<std::vector<bool>>> owner_tables(numSets,
+        std::vector<std::vector<bool>>(numPar, std::vector<bool>(numWay, false)));
+    std::vector<std::vector<std::vector<ParEntry>>> par_tables(numSets,
+        std::vector<std::vector<ParEntry>>(numPar));
+    std::vector<std::vector<ReplaceableEntry>> entries(numSets);
+    std::vector<ReplacementCandidates> candidates(numSets);
+    for (int set = 0; set < numSets; ++set) {
+        entries[set].resize(numWay);
+        for (int way = 0; way < numWay; ++way) {
+            entries[set][way].setPosition(set, way);
+            candidates[set].push_back(&entries[set][way]);
+            ++tick;
+            owner_tables[set][way / parSize][way] = true;
+            par_tables[set][way / parSize].push_back({way, lru.instantiateEntry()});
+            lru.reset(par_tables[set][way / parSize].back().repl_data);
+        }
+    }
+
+    return timeSelections("allocating selection (former ParRP)", [&] {
+        for (const Selection &s : selections) {
+            ReplacementCandidates par_candidates;
+            for (auto &candidate : candidates[s.set]) {
+                int way_index = candidate->getWay();
+                if (owner_tables[s.set][s.par_id][way_index]) {
+                    ReplaceableEntry *par_candidate = new ReplaceableEntry();
+                    for (ParEntry &par_entry : par_tables[s.set][s.par_id]) {
+                        if (par_entry.way_index == way_index) {
+                            par_candidate->replacementData = par_entry.repl_data;
+                        }
+                    }
+                    par_candidate->setPosition(0, way_index);
+                    par_candidates.push_back(par_candidate);
+                }
+            }
+            victimWay += lru.getVictim(par_candidates)->getWay();
+            for (auto &par_candidate : par_candidates) {
+                delete par_candidate;
+            }
+        }
+    });
+}
+
+/** The selection of a partitioned policy on sets whose partitions are full. */
+template <class Params, class Policy>
+double
+benchParSelection(const char *name, const std::vector<Selection> &selections,
+                  replacement_policy::Base *repl_policy)
+{
+    Params params;
+    params.name = name;
+    params.eventq_index = 0;
+    params.replacement_policy = repl_policy;
+    params.par_config = std::vector<int>(numPar, parSize);
+    params.num_way = numWay;
+    params.resizable = false;
+    params.utility_monitor = nullptr;
+    params.stats_sampling_interval = 64;
+    Policy rp(params);
+
+    std::vector<std::vector<ReplaceableEntry>> entries(numSets);
+    std::vector<ReplacementCandidates> candidates(numSets);
+    for (int set = 0; set < numSets; ++set) {
+        entries[set].resize(numWay);
+        for (int way = 0; way < numWay; ++way) {
+            entries[set][way].replacementData = rp.instantiateEntry();
+            entries[set][way].setPosition(set, way);
+            candidates[set].push_back(&entries[set][way]);
+        }
+        for (int way = 0; way < numWay; ++way) {
+            ++tick;
+            rp.reset(entries[set][way].replacementData, way / parSize);
+        }
+    }
+
+    return timeSelections(name, [&] {
+        for (const Selection &s : selections) {
+            victimWay += rp.getVictim(candidates[s.set], s.par_id)->getWay();
+        }
+    });
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    Gem5Internal::_curTickPtr = &tick;
+    const std::vector<Selection> selections = makeSelections();
+
+    ccprintf(std::cout, "%d partition victim selections, %d partitions of %d ways\n",
+             numSelections, numPar, parSize);
+    const double allocating_ns = benchAllocatingSelection(selections);
+    const uint64_t allocating_victims = victimWay;
+
+    LRURPParams lru_params;
+    lru_params.name = "lru";
+    lru_params.eventq_index = 0;
+    replacement_policy::LRU lru(lru_params);
+    const double par_ns = benchParSelection<ParRPParams, replacement_policy::Par>(
+        "ParRP wrapping LRURP", selections, &lru);
+    panic_if(victimWay != allocating_victims, "ParRP selected other victims.");
+    const double native_ns = benchParSelection<ParLRURPParams, replacement_policy::ParLRU>(
+        "ParLRURP", selections, nullptr);
+    panic_if(victimWay != allocating_victims, "ParLRURP selected other victims.");
+
+    ccprintf(std::cout, "speedup over the allocating selection: "
+             "ParRP %.2fx, ParLRURP %.2fx\n",
+             allocating_ns / par_ns, allocating_ns / native_ns);
+    return 0;
+}
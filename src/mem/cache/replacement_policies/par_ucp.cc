@@ -0,0 +1,184 @@
+#include "mem/cache/replacement_policies/par_ucp.hh"
+
+#include <cassert>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/RP.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
+#include "params/ParUtilityMonitor.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
+namespace replacement_policy
+{
+
+ParUtilityMonitor::ParUtilityMonitor(const Params &p)
+    : SimObject(p),
+      policy(nullptr),
+      numPar(0),
+      numWay(0),
+      samplingInterval(p.sampling_interval),
+      repartitionPeriod(p.repartition_period),
+      minWays(p.min_ways),
+      repartitionEvent([this]{ repartition(); }, name()),
+      parUtilityMonitorStats(*this)
+{
+    fatal_if(samplingInterval == 0, "The sampling interval must be at least 1.");
+    fatal_if(repartitionPeriod == 0, "The repartition period must not be 0.");
+    fatal_if(minWays < 1, "A partition must keep at least one way.");
+}
+
+void
+ParUtilityMonitor::setPolicy(Par* par_policy, const std::vector<int>& par_config, int num_way)
+{
+    fatal_if(policy != nullptr,
+        "A utility monitor can only monitor a single replacement policy.");
+    fatal_if(par_config.size() * minWays > num_way,
+        "Not enough ways to give every partition its minimum number of ways.");
+    policy = par_policy;
+    numPar = par_config.size();
+    numWay = num_way;
+    allocation = par_config;
+    hitCounters.assign(numPar * numWay, 0);
+}
+
+void
+ParUtilityMonitor::startup()
+{
+    fatal_if(policy == nullptr,
+        "The utility monitor is not attached to a partitioned replacement policy.");
+    for (int i = 0; i < numPar; ++i) {
+        parUtilityMonitorStats.m_allocation[i] = allocation[i];
+    }
+    schedule(repartitionEvent, curTick() + repartitionPeriod);
+}
+
+void
+ParUtilityMonitor::access(uint64_t set, Addr line_addr, int par_id)
+{
+    if (set % samplingInterval != 0) {
+        return;
+    }
+    assert(par_id < numPar);
+
+    // shadow tags of a sampled set are created on its first access
+    const size_t stack_offset = ((set / samplingInterval) * numPar + par_id) * numWay;
+    if (stack_offset >= shadowTags.size()) {
+        shadowTags.resize(stack_offset - par_id * numWay + numPar * numWay, MaxAddr);
+    }
+    Addr* stack = &shadowTags[stack_offset];
+
+    parUtilityMonitorStats.m_sampled_access[par_id]++;
+    int position = 0;
+    while (position < numWay && stack[position] != line_addr) {
+        ++position;
+    }
+    if (position < numWay) {
+        hitCounters[par_id * numWay + position]++;
+        parUtilityMonitorStats.m_sampled_hit[par_id]++;
+    } else {
+        // miss, the LRU tag is dropped
+        position = numWay - 1;
+    }
+
+    // move the line to the MRU position
+    for (int i = position; i > 0; --i) {
+        stack[i] = stack[i - 1];
+    }
+    stack[0] = line_addr;
+}
+
+std::vector<int>
+ParUtilityMonitor::lookahead() const
+{
+    std::vector<int> new_allocation(numPar, minWays);
+    int balance = numWay - numPar * minWays;
+    while (balance > 0) {
+        double best_utility = -1;
+        int best_par_id = 0;
+        int best_num_ways = 1;
+        for (int i = 0; i < numPar; ++i) {
+            // marginal utility per way of giving k more ways to the partition
+            uint64_t hits = 0;
+            for (int k = 1; k <= balance; ++k) {
+                hits += hitCounters[i * numWay + new_allocation[i] + k - 1];
+                double utility = (double)hits / k;
+                if (utility > best_utility) {
+                    best_utility = utility;
+                    best_par_id = i;
+                    best_num_ways = k;
+                }
+            }
+        }
+        new_allocation[best_par_id] += best_num_ways;
+        balance -= best_num_ways;
+    }
+    return new_allocation;
+}
+
+void
+ParUtilityMonitor::repartition()
+{
+    uint64_t tot_hits = 0;
+    for (uint64_t hits : hitCounters) {
+        tot_hits += hits;
+    }
+
+    // keep the current allocation when nothing was observed
+    if (tot_hits != 0) {
+        allocation = lookahead();
+        policy->resize(allocation);
+        parUtilityMonitorStats.m_num_repartition++;
+        for (int i = 0; i < numPar; ++i) {
+            DPRINTF(RP, "repartition: par %d gets %d ways\n", i, allocation[i]);
+        }
+
+        // halve the counters, so that the allocation follows program phases
+        for (uint64_t& hits : hitCounters) {
+            hits /= 2;
+        }
+    }
+
+    for (int i = 0; i < numPar; ++i) {
+        parUtilityMonitorStats.m_allocation[i] = allocation[i];
+        parUtilityMonitorStats.m_allocation_dist[i].sample(allocation[i]);
+    }
+
+    schedule(repartitionEvent, curTick() + repartitionPeriod);
+}
+
+ParUtilityMonitor::ParUtilityMonitorStats::ParUtilityMonitorStats(ParUtilityMonitor &parent)
+    : statistics::Group(&parent),
+      monitor(parent),
+      ADD_STAT(m_num_repartition, statistics::units::Count::get(),
+               "Number of partition size updates"),
+      ADD_STAT(m_sampled_access, statistics::units::Count::get(),
+               "Accesses to the sampled sets per partition"),
+      ADD_STAT(m_sampled_hit, statistics::units::Count::get(),
+               "Shadow tag hits in the sampled sets per partition"),
+      ADD_STAT(m_allocation, statistics::units::Count::get(),
+               "Current number of ways per partition"),
+      ADD_STAT(m_allocation_dist, statistics::units::Count::get(),
+               "Number of ways per partition over the repartition periods")
+{
+}
+
+void
+ParUtilityMonitor::ParUtilityMonitorStats::regStats()
+{
+    statistics::Group::regStats();
+
+    m_sampled_access.init(monitor.numPar);
+    m_sampled_hit.init(monitor.numPar);
+    m_allocation.init(monitor.numPar);
+    m_allocation_dist
+        .init(monitor.numPar, 0, monitor.numWay, 1)
+        .flags(statistics::nozero);
+}
+
+} // namespace replacement_policy
+} // namespace gem5
@@ -0,0 +1,117 @@
+/**
+ * @file
+ * Utility monitor that sizes the partitions of the Par replacement policy automatically,
+ * following utility-based cache partitioning (UCP, Qureshi and Patt, MICRO 2006).
+ *
+ * A few cache sets are sampled. For each sampled set, every partition has an auxiliary
+ * tag directory (shadow tags) that holds the tags the partition would cache if it owned the
+ * whole set, in LRU order. A hit at LRU stack position i means the access would hit with
+ * i + 1 ways or more, so the hit counters per position give the marginal utility of each way.
+ * Periodically, the lookahead algorithm distributes the ways according to these utilities
+ * and the new partition sizes are fed into the (resizable) replacement policy.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_POLICIES_PAR_UCP_HH__
+#define __MEM_CACHE_REPLACEMENT_POLICIES_PAR_UCP_HH__
+
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+namespace gem5
+{
+
+struct ParUtilityMonitorParams;
+
+GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
+namespace replacement_policy
+{
+
+class Par;
+
+class ParUtilityMonitor : public SimObject
+{
+    protected:
+        /** Monitored replacement policy, set when the policy is constructed. */
+        Par* policy;
+
+        /** Number of partitions and ways of the monitored policy. */
+        int numPar;
+        int numWay;
+
+        /** One cache set out of samplingInterval is monitored. */
+        const unsigned samplingInterval;
+
+        /** Period of the partition size updates. */
+        const Tick repartitionPeriod;
+
+        /** Minimum number of ways allocated to a partition. */
+        const int minWays;
+
+        /** Current partition sizes. */
+        std::vector<int> allocation;
+
+        /**
+         * Shadow tags: one LRU stack of line addresses (MRU first) per partition per sampled set.
+         * The stack of partition p in the i-th sampled set is at [(i * numPar + p) * numWay, +numWay).
+         */
+        std::vector<Addr> shadowTags;
+
+        /** Shadow tag hits per LRU stack position, at [par_id * numWay + position]. */
+        std::vector<uint64_t> hitCounters;
+
+        EventFunctionWrapper repartitionEvent;
+
+        /**
+         * Lookahead allocation: repeatedly give the partition with the highest marginal
+         * utility per way the number of ways that achieves it, until all ways are allocated.
+         */
+        std::vector<int> lookahead() const;
+
+        /** Compute new partition sizes and feed them into the policy. */
+        void repartition();
+
+        struct ParUtilityMonitorStats : public statistics::Group
+        {
+            ParUtilityMonitorStats(ParUtilityMonitor &parent);
+
+            void regStats() override;
+
+            const ParUtilityMonitor &monitor;
+
+            statistics::Scalar m_num_repartition;
+            statistics::Vector m_sampled_access;
+            statistics::Vector m_sampled_hit;
+            statistics::Vector m_allocation;
+            statistics::VectorDistribution m_allocation_dist;
+        } parUtilityMonitorStats;
+
+    public:
+        typedef ParUtilityMonitorParams Params;
+        ParUtilityMonitor(const Params &p);
+
+        /**
+         * Attach the monitor to a partitioned replacement policy.
+         * Called by the policy on construction.
+         */
+        void setPolicy(Par* par_policy, const std::vector<int>& par_config, int num_way);
+
+        /**
+         * Record an access of a partition to a cache line.
+         *
+         * @param set Cache set of the line.
+         * @param line_addr Line address.
+         * @param par_id Partition (core) accessing the line.
+         */
+        void access(uint64_t set, Addr line_addr, int par_id);
+
+        void startup() override;
+};
+
+} // namespace replacement_policy
+} // namespace gem5
+
+#endif // __MEM_CACHE_REPLACEMENT_POLICIES_PAR_UCP_HH__
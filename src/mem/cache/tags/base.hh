@@ -282,6 +282,20 @@ class BaseTags : public ClockedObject
                                  const std::size_t size,
                                  std::vector<CacheBlk*>& evict_blks) = 0;
 
+    /**
+     * Find replacement victim for a partition of a partitioned replacement
+     * policy. Tags that do not support partitions ignore the partition.
+     *
+     * @param par_id Partition of the requestor allocating the block.
+     */
+    virtual CacheBlk* findVictim(Addr addr, const bool is_secure,
+                                 const std::size_t size,
+                                 std::vector<CacheBlk*>& evict_blks,
+                                 int par_id)
+    {
+        return findVictim(addr, is_secure, size, evict_blks);
+    }
+
     /**
      * Access block and update replacement data. May not succeed, in which case
      * nullptr is returned. This has all the implications of a cache access and
@@ -294,6 +308,19 @@ class BaseTags : public ClockedObject
      */
     virtual CacheBlk* accessBlock(const PacketPtr pkt, Cycles &lat) = 0;
 
+    /**
+     * Access block on behalf of a partition of a partitioned replacement
+     * policy. Tags that do not support partitions ignore the partition.
+     *
+     * @param par_id Partition of the requestor, -1 if the requestor does not
+     *               belong to any partition.
+     */
+    virtual CacheBlk* accessBlock(const PacketPtr pkt, Cycles &lat,
+                                  int par_id)
+    {
+        return accessBlock(pkt, lat);
+    }
+
     /**
      * Generate the tag from the given address.
      *
@@ -310,6 +337,17 @@ class BaseTags : public ClockedObject
      */
     virtual void insertBlock(const PacketPtr pkt, CacheBlk *blk);
 
+    /**
+     * Insert the new block into a partition of a partitioned replacement
+     * policy. Tags that do not support partitions ignore the partition.
+     *
+     * @param par_id Partition of the requestor allocating the block.
+     */
+    virtual void insertBlock(const PacketPtr pkt, CacheBlk *blk, int par_id)
+    {
+        insertBlock(pkt, blk);
+    }
+
     /**
      * Move a block's metadata to another location decided by the replacement
      * policy. It behaves as a swap, however, since the destination block
@@ -48,6 +48,8 @@
 #include <string>
 
 #include "base/intmath.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
+#include "mem/cache/replacement_policies/par_ucp.hh"
 
 namespace gem5
 {
@@ -55,7 +57,8 @@ namespace gem5
 BaseSetAssoc::BaseSetAssoc(const Params &p)
     :BaseTags(p), allocAssoc(p.assoc), blks(p.size / p.block_size),
      sequentialAccess(p.sequential_access),
-     replacementPolicy(p.replacement_policy)
+     replacementPolicy(p.replacement_policy),
+     parPolicy(dynamic_cast<replacement_policy::Par*>(p.replacement_policy))
 {
     // There must be a indexing policy
     fatal_if(!p.indexing_policy, "An indexing policy is required");
@@ -93,13 +96,142 @@ BaseSetAssoc::invalidate(CacheBlk *blk)
     // Decrease the number of tags in use
     stats.tagsInUse--;
 
+    // The block leaves all the partitions sharing it
+    if (parPolicy != nullptr) {
+        parPolicy->release(blk->replacementData);
+    }
+
     // Invalidate replacement data
     replacementPolicy->invalidate(blk->replacementData);
 }
 
+CacheBlk*
+BaseSetAssoc::accessBlock(const PacketPtr pkt, Cycles &lat, int par_id)
+{
+    if (parPolicy == nullptr) {
+        return accessBlock(pkt, lat);
+    }
+
+    CacheBlk *blk = findBlock(pkt->getAddr(), pkt->isSecure());
+
+    updateAccessStats(blk);
+
+    // The tag lookup latency is the same for a hit or a miss
+    lat = lookupLatency;
+
+    if (blk != nullptr) {
+        // Update number of references to accessed block
+        blk->increaseRefCount();
+    }
+
+    if (par_id < 0) {
+        return blk;
+    }
+    assert(par_id < parPolicy->getNumPar());
+
+    if (blk != nullptr) {
+        if (!parPolicy->parHit(blk->replacementData, par_id)) {
+            // The partition claims a block brought in by another partition,
+            // it gives up its own blocks until it has room for it
+            // (more than one after a shrinking resize)
+            while (!parPolicy->parAvail(blk->replacementData, par_id)) {
+                const std::vector<ReplaceableEntry*> entries =
+                    indexingPolicy->getPossibleEntries(pkt->getAddr());
+                parPolicy->invalidate(
+                    parPolicy->getVictim(entries, par_id)->replacementData,
+                    par_id);
+            }
+        }
+
+        // Update replacement data of accessed block
+        parPolicy->touch(blk->replacementData, par_id);
+    }
+
+    replacement_policy::ParUtilityMonitor* monitor =
+        parPolicy->getUtilityMonitor();
+    if (monitor != nullptr) {
+        const uint32_t set = blk != nullptr ? blk->getSet() :
+            indexingPolicy->getPossibleEntries(pkt->getAddr())[0]->getSet();
+        monitor->access(set, pkt->getBlockAddr(blkSize), par_id);
+    }
+
+    return blk;
+}
+
+CacheBlk*
+BaseSetAssoc::findVictim(Addr addr, const bool is_secure,
+                         const std::size_t size,
+                         std::vector<CacheBlk*>& evict_blks, int par_id)
+{
+    if (parPolicy == nullptr) {
+        return findVictim(addr, is_secure, size, evict_blks);
+    }
+    assert(par_id >= 0 && par_id < parPolicy->getNumPar());
+
+    // Get possible entries to be victimized
+    const std::vector<ReplaceableEntry*> entries =
+        indexingPolicy->getPossibleEntries(addr);
+
+    // Make room in the partition. The blocks given up stay valid, and are
+    // replaced by the following allocations in the set.
+    while (!parPolicy->parAvail(entries[0]->replacementData, par_id)) {
+        parPolicy->invalidate(
+            parPolicy->getVictim(entries, par_id)->replacementData, par_id);
+    }
+
+    // Prefer an invalid block, invalid blocks are never owned. With way
+    // masks, only the ways of the partition are considered.
+    CacheBlk* victim = nullptr;
+    std::vector<ReplaceableEntry*> allowed_entries;
+    for (ReplaceableEntry* entry : entries) {
+        if (!parPolicy->parAllowed(entry->replacementData, par_id)) {
+            continue;
+        }
+        if (!static_cast<CacheBlk*>(entry)->isValid()) {
+            victim = static_cast<CacheBlk*>(entry);
+            break;
+        }
+        allowed_entries.push_back(entry);
+    }
+
+    // Otherwise replace a block no partition owns, or with way masks,
+    // a partition victim
+    if (victim == nullptr) {
+        victim = static_cast<CacheBlk*>(
+            parPolicy->getVictim(allowed_entries));
+    }
+
+    // There is only one eviction for this replacement
+    evict_blks.push_back(victim);
+
+    return victim;
+}
+
+void
+BaseSetAssoc::insertBlock(const PacketPtr pkt, CacheBlk *blk, int par_id)
+{
+    if (parPolicy == nullptr) {
+        insertBlock(pkt, blk);
+        return;
+    }
+    assert(par_id >= 0 && par_id < parPolicy->getNumPar());
+
+    // Insert block
+    BaseTags::insertBlock(pkt, blk);
+
+    // Increment tag counter
+    stats.tagsInUse++;
+
+    // The block joins the partition of the requestor
+    parPolicy->reset(blk->replacementData, par_id);
+}
+
 void
 BaseSetAssoc::moveBlock(CacheBlk *src_blk, CacheBlk *dest_blk)
 {
+    fatal_if(parPolicy != nullptr,
+        "Moving blocks is not supported by partitioned replacement policies");
+
     BaseTags::moveBlock(src_blk, dest_blk);
 
     // Since the blocks were using different replacement data pointers,
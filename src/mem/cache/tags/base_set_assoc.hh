@@ -65,6 +65,12 @@
 namespace gem5
 {
 
+GEM5_DEPRECATED_NAMESPACE(ReplacementPolicy, replacement_policy);
+namespace replacement_policy
+{
+class Par;
+}
+
 /**
  * A basic cache tag store.
  * @sa  \ref gem5MemorySystem "gem5 Memory System"
@@ -87,6 +93,33 @@ class BaseSetAssoc : public BaseTags
     /** Replacement policy */
     replacement_policy::Base *replacementPolicy;
 
+    /**
+     * The replacement policy if it is partitioned (ParRP), nullptr otherwise.
+     * A partitioned policy is driven through the par_id overloads of
+     * accessBlock(), findVictim() and insertBlock().
+     */
+    replacement_policy::Par *parPolicy;
+
+    /**
+     * Update the tag and data access stats of a lookup.
+     *
+     * @param blk The block found by the lookup, nullptr on a miss.
+     */
+    void updateAccessStats(const CacheBlk *blk)
+    {
+        // Access all tags in parallel, hence one in each way.  The data side
+        // either accesses all blocks in parallel, or one block sequentially on
+        // a hit.  Sequential access with a miss doesn't access data.
+        stats.tagAccesses += allocAssoc;
+        if (sequentialAccess) {
+            if (blk != nullptr) {
+                stats.dataAccesses += 1;
+            }
+        } else {
+            stats.dataAccesses += allocAssoc;
+        }
+    }
+
   public:
     /** Convenience typedef. */
      typedef BaseSetAssocParams Params;
@@ -128,17 +161,7 @@ class BaseSetAssoc : public BaseTags
     {
         CacheBlk *blk = findBlock(pkt->getAddr(), pkt->isSecure());
 
-        // Access all tags in parallel, hence one in each way.  The data side
-        // either accesses all blocks in parallel, or one block sequentially on
-        // a hit.  Sequential access with a miss doesn't access data.
-        stats.tagAccesses += allocAssoc;
-        if (sequentialAccess) {
-            if (blk != nullptr) {
-                stats.dataAccesses += 1;
-            }
-        } else {
-            stats.dataAccesses += allocAssoc;
-        }
+        updateAccessStats(blk);
 
         // If a cache hit
         if (blk != nullptr) {
@@ -155,6 +178,22 @@ class BaseSetAssoc : public BaseTags
         return blk;
     }
 
+    /**
+     * Access block on behalf of a partition of the partitioned replacement
+     * policy. A block that is present but not owned by the partition is
+     * claimed by it, after the partition gave up one of its blocks if it is
+     * full. The given up block stays valid until it is replaced.
+     * Requestors that do not belong to a partition (par_id -1, e.g.
+     * writebacks) do not update the replacement data.
+     *
+     * @param pkt The packet holding the address to find.
+     * @param lat The latency of the tag lookup.
+     * @param par_id Partition of the requestor, -1 if none.
+     * @return Pointer to the cache block if found.
+     */
+    CacheBlk* accessBlock(const PacketPtr pkt, Cycles &lat,
+                          int par_id) override;
+
     /**
      * Find replacement victim based on address. The list of evicted blocks
      * only contains the victim.
@@ -183,6 +222,20 @@ class BaseSetAssoc : public BaseTags
         return victim;
     }
 
+    /**
+     * Find replacement victim for a partition of the partitioned replacement
+     * policy. If the partition is full, it first gives up one of its blocks.
+     * The victim is then an invalid block, or a block that no partition owns.
+     * With way masks, the victim is in the ways of the partition, and is an
+     * invalid block or a partition victim.
+     *
+     * @param par_id Partition of the requestor allocating the block.
+     */
+    CacheBlk* findVictim(Addr addr, const bool is_secure,
+                         const std::size_t size,
+                         std::vector<CacheBlk*>& evict_blks,
+                         int par_id) override;
+
     /**
      * Insert the new block into the cache and update replacement data.
      *
@@ -201,6 +254,14 @@ class BaseSetAssoc : public BaseTags
         replacementPolicy->reset(blk->replacementData, pkt);
     }
 
+    /**
+     * Insert the new block into a partition of the partitioned replacement
+     * policy.
+     *
+     * @param par_id Partition of the requestor allocating the block.
+     */
+    void insertBlock(const PacketPtr pkt, CacheBlk *blk, int par_id) override;
+
     void moveBlock(CacheBlk *src_blk, CacheBlk *dest_blk) override;
 
     /**
@@ -100,6 +100,7 @@ MessageBuffer::MessageBuffer(const Params &p)
     m_stall_time = 0;
 
     m_dequeue_callback = nullptr;
+    m_enqueue_callback = nullptr;
 
     // stats
     m_not_avail_count
@@ -289,6 +290,10 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
             arrival_time, *(message.get()));
 
+    if (m_enqueue_callback) {
+        m_enqueue_callback(message);
+    }
+
     // Schedule the wakeup
     assert(m_consumer != NULL);
     m_consumer->scheduleEventAbsolute(arrival_time);
@@ -301,8 +306,29 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     DPRINTF(RubyQueue, "Popping\n");
     assert(isReady(current_time));
 
+    return dequeueAt(0, current_time, decrement_messages);
+}
+
+Tick
+MessageBuffer::dequeue(const MsgPtr &message, Tick current_time,
+                       bool decrement_messages)
+{
+    DPRINTF(RubyQueue, "Popping %s\n", *message);
+    assert(isReady(current_time));
+    assert(message->getLastEnqueueTime() <= current_time);
+
+    auto it = std::find(m_prio_heap.begin(), m_prio_heap.end(), message);
+    assert(it != m_prio_heap.end());
+    return dequeueAt(it - m_prio_heap.begin(), current_time,
+                     decrement_messages);
+}
+
+Tick
+MessageBuffer::dequeueAt(size_t pos, Tick current_time,
+                         bool decrement_messages)
+{
     // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = m_prio_heap[pos];
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -318,8 +344,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     }
     ++m_dequeues_this_cy;
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    removeFromHeap(pos);
     if (decrement_messages) {
         // Record how much time is passed since the message was enqueued
         m_stall_time += curTick() - message->getLastEnqueueTime();
@@ -338,12 +363,58 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     return delay;
 }
 
+void
+MessageBuffer::removeFromHeap(size_t pos)
+{
+    if (pos == 0) {
+        pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
+                 std::greater<MsgPtr>());
+        m_prio_heap.pop_back();
+        return;
+    }
+
+    // Fill the hole with the last message, then move it up or down to
+    // restore the heap order
+    m_prio_heap[pos] = m_prio_heap.back();
+    m_prio_heap.pop_back();
+    if (pos == m_prio_heap.size()) {
+        return;
+    }
+
+    if (m_prio_heap[(pos - 1) / 2] > m_prio_heap[pos]) {
+        // the messages before the hole are still a heap
+        push_heap(m_prio_heap.begin(), m_prio_heap.begin() + pos + 1,
+                  std::greater<MsgPtr>());
+        return;
+    }
+
+    size_t size = m_prio_heap.size();
+    while (2 * pos + 1 < size) {
+        size_t child = 2 * pos + 1;
+        if (child + 1 < size && m_prio_heap[child] > m_prio_heap[child + 1]) {
+            child++;
+        }
+        if (!(m_prio_heap[pos] > m_prio_heap[child])) {
+            break;
+        }
+        std::swap(m_prio_heap[pos], m_prio_heap[child]);
+        pos = child;
+    }
+}
+
 void
 MessageBuffer::registerDequeueCallback(std::function<void()> callback)
 {
     m_dequeue_callback = callback;
 }
 
+void
+MessageBuffer::registerEnqueueCallback(
+    std::function<void(const MsgPtr &)> callback)
+{
+    m_enqueue_callback = callback;
+}
+
 void
 MessageBuffer::unregisterDequeueCallback()
 {
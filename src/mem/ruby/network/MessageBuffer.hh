@@ -141,9 +141,18 @@ class MessageBuffer : public SimObject
     //! removes it from the queue and returns its total delay.
     Tick dequeue(Tick current_time, bool decrement_messages = true);
 
+    //! Same as dequeue() for a ready message anywhere in the queue, e.g. the
+    //! one picked by an arbiter that does not follow the arrival order.
+    Tick dequeue(const MsgPtr &message, Tick current_time,
+                 bool decrement_messages = true);
+
     void registerDequeueCallback(std::function<void()> callback);
     void unregisterDequeueCallback();
 
+    //! Called with every message enqueued, e.g. to index the messages
+    //! by another key than their arrival time.
+    void registerEnqueueCallback(std::function<void(const MsgPtr &)> callback);
+
     void recycle(Tick current_time, Tick recycle_latency);
     bool isEmpty() const { return m_prio_heap.size() == 0; }
     bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
@@ -192,20 +201,22 @@ class MessageBuffer : public SimObject
 
     int routingPriority() const { return m_routing_priority; }
 
-    std::vector<MsgPtr> m_prio_heap;
-
   private:
     void reanalyzeList(std::list<MsgPtr> &, Tick);
 
     uint32_t functionalAccess(Packet *pkt, bool is_read, WriteMask *mask);
 
+    Tick dequeueAt(size_t pos, Tick current_time, bool decrement_messages);
+    void removeFromHeap(size_t pos);
+
   private:
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
-    //std::vector<MsgPtr> m_prio_heap;  // Move to public for hacking
+    std::vector<MsgPtr> m_prio_heap;
 
     std::function<void()> m_dequeue_callback;
+    std::function<void(const MsgPtr &)> m_enqueue_callback;
 
     // use a std::map for the stalled messages as this container is
     // sorted and ensures a well-defined iteration order
@@ -0,0 +1,46 @@
+#include "mem/ruby/network/snooping/OldestAgeArbiter.hh"
+
+#include <cassert>
+
+#include "mem/ruby/network/MessageBuffer.hh"
+#include "mem/ruby/protocol/ResponseMsg.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+void
+OldestAgeArbiter::insert(MessageBuffer *buffer, const MsgPtr &msg)
+{
+    const ResponseMsg *resp = dynamic_cast<const ResponseMsg *>(msg.get());
+    assert(resp != nullptr);
+
+    m_pending.push({resp->m_reqID, buffer->getIncomingLink(), m_seq++,
+                    msg->getLastEnqueueTime(), buffer, msg});
+}
+
+const OldestAgeArbiter::Entry *
+OldestAgeArbiter::select(Tick current_time)
+{
+    while (!m_pending.empty() && m_pending.top().ready_time <= current_time) {
+        m_ready.insert(m_pending.top());
+        m_pending.pop();
+    }
+
+    if (m_ready.empty()) {
+        return nullptr;
+    }
+    return &*m_ready.begin();
+}
+
+void
+OldestAgeArbiter::pop()
+{
+    assert(!m_ready.empty());
+    m_ready.erase(m_ready.begin());
+}
+
+} // namespace ruby
+} // namespace gem5
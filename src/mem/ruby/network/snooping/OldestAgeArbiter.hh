@@ -0,0 +1,93 @@
+/**
+ * @file
+ * Oldest age arbitration of the snooping response bus.
+ *
+ * The responses are indexed as they are enqueued in the input buffers of the bus,
+ * so that a bus cycle selects the ready response with the lowest request ID
+ * (i.e. answering the oldest request) in O(log n) instead of scanning every message
+ * of every buffer. The responses wait in a heap ordered by arrival time until they
+ * are ready, then in a set ordered by request ID.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_SNOOPING_OLDESTAGEARBITER_HH__
+#define __MEM_RUBY_NETWORK_SNOOPING_OLDESTAGEARBITER_HH__
+
+#include <cstdint>
+#include <queue>
+#include <set>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+class MessageBuffer;
+
+class OldestAgeArbiter
+{
+  public:
+    struct Entry
+    {
+        Cycles req_id;
+        // input port of the buffer, to break the ties
+        int port;
+        // enqueue order
+        uint64_t seq;
+        Tick ready_time;
+        MessageBuffer *buffer;
+        MsgPtr msg;
+    };
+
+    /** Index a response enqueued in the input buffer of a port. */
+    void insert(MessageBuffer *buffer, const MsgPtr &msg);
+
+    /** The ready response with the lowest request ID, nullptr if none is ready. */
+    const Entry *select(Tick current_time);
+
+    /** Remove the selected response, once it is dequeued from its buffer. */
+    void pop();
+
+    bool empty() const { return m_pending.empty() && m_ready.empty(); }
+
+  private:
+    struct LaterReady
+    {
+        bool
+        operator()(const Entry &a, const Entry &b) const
+        {
+            if (a.ready_time != b.ready_time) {
+                return a.ready_time > b.ready_time;
+            }
+            return a.seq > b.seq;
+        }
+    };
+
+    struct HigherPriority
+    {
+        bool
+        operator()(const Entry &a, const Entry &b) const
+        {
+            if (a.req_id != b.req_id) {
+                return a.req_id < b.req_id;
+            }
+            if (a.port != b.port) {
+                return a.port < b.port;
+            }
+            return a.seq < b.seq;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, LaterReady> m_pending;
+    std::set<Entry, HigherPriority> m_ready;
+    uint64_t m_seq = 0;
+};
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_SNOOPING_OLDESTAGEARBITER_HH__
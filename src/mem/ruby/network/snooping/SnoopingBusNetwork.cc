@@ -0,0 +1,461 @@
+#include "mem/ruby/network/snooping/SnoopingBusNetwork.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "debug/RubyNetwork.hh"
+#include "debug/TDM.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/network/MessageBuffer.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+SnoopingBusNetwork::SnoopingBusNetwork(const Params &p)
+    : Network(p), Consumer(this),
+      m_request_bus_vnet(p.request_bus_vnet),
+      m_response_bus_vnet(p.response_bus_vnet),
+      m_tdm_slot_width(p.tdm_slot_width),
+      m_resp_bus_slot_width(p.resp_bus_slot_width),
+      m_tdm_arbitration(p.tdm_arbitration),
+      m_tdm_slot_table(p.tdm_slot_table),
+      m_tdm_critical_cores(p.tdm_critical_cores),
+      m_transfer_latency(p.transfer_latency),
+      m_pending_message_count(p.number_of_virtual_networks, 0),
+      busStats(this, getToNetQueues(p.request_bus_vnet).size())
+{
+    fatal_if(m_request_bus_vnet >= p.number_of_virtual_networks ||
+             m_response_bus_vnet >= p.number_of_virtual_networks,
+             "The bus vnets must be virtual networks of the network\n");
+    fatal_if(m_tdm_slot_width == 0 || m_resp_bus_slot_width == 0,
+             "The bus slots must last at least one cycle\n");
+    fatal_if(m_transfer_latency == 0,
+             "The bus transfer latency must last at least one cycle\n");
+
+    // The controllers registered their buffers when the base network was built
+    for (int vnet = 0; vnet < p.number_of_virtual_networks; vnet++) {
+        m_in.push_back(getToNetQueues(vnet));
+    }
+
+    // The requestors are the nodes with a buffer on the request bus. The L1s
+    // come first in node order, so that core i is requestor i
+    m_req_bus_in = m_in[m_request_bus_vnet];
+    int num_requestors = m_req_bus_in.size();
+    fatal_if(num_requestors == 0, "No node sends on the request bus\n");
+    m_tdm_is_critical.resize(num_requestors, false);
+    m_req_bus_ready.resize(num_requestors, false);
+
+    for (int core : m_tdm_critical_cores) {
+        fatal_if(core < 0 || core >= num_requestors,
+                 "Critical core %d is not a core of the bus\n", core);
+        m_tdm_is_critical[core] = true;
+    }
+    for (int core : m_tdm_slot_table) {
+        fatal_if(core < -1 || core >= num_requestors,
+                 "Slot owner %d is not a core of the bus\n", core);
+        fatal_if(m_tdm_arbitration == TDMArbitration::hybrid &&
+                 core >= 0 && !m_tdm_is_critical[core],
+                 "Slot owner %d of the hybrid schedule is not a critical "
+                 "core\n", core);
+    }
+    fatal_if(m_tdm_arbitration == TDMArbitration::weighted &&
+             m_tdm_slot_table.empty(),
+             "The weighted TDM schedule requires a slot table\n");
+    fatal_if(m_tdm_arbitration == TDMArbitration::hybrid &&
+             m_tdm_critical_cores.empty(),
+             "The hybrid TDM schedule requires critical cores\n");
+}
+
+std::vector<MessageBuffer*>
+SnoopingBusNetwork::getToNetQueues(int vnet) const
+{
+    std::vector<MessageBuffer*> queues;
+    for (NodeID node = 0; node < m_nodes; node++) {
+        if (m_toNetQueues[node].size() > vnet &&
+            m_toNetQueues[node][vnet] != nullptr) {
+            queues.push_back(m_toNetQueues[node][vnet]);
+        }
+    }
+    return queues;
+}
+
+void
+SnoopingBusNetwork::init()
+{
+    Network::init();
+
+    for (NodeID node = 0; node < m_nodes; node++) {
+        for (int vnet = 0; vnet < m_toNetQueues[node].size(); vnet++) {
+            MessageBuffer *buffer = m_toNetQueues[node][vnet];
+            if (buffer == nullptr) {
+                continue;
+            }
+            buffer->setConsumer(this);
+            buffer->setIncomingLink(node);
+            buffer->setVnet(vnet);
+
+            // Index the responses by request ID as they arrive
+            if (vnet == m_response_bus_vnet) {
+                buffer->registerEnqueueCallback(
+                    [this, buffer](const MsgPtr &msg)
+                    { m_resp_bus_arbiter.insert(buffer, msg); });
+            }
+        }
+    }
+}
+
+void
+SnoopingBusNetwork::makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
+                                   std::vector<NetDest>& routing_table_entry)
+{
+    panic("%s: the snooping bus has no links\n", name());
+}
+
+void
+SnoopingBusNetwork::makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
+                                  std::vector<NetDest>& routing_table_entry)
+{
+    panic("%s: the snooping bus has no links\n", name());
+}
+
+void
+SnoopingBusNetwork::makeInternalLink(SwitchID src, SwitchID dest,
+                                     BasicLink* link,
+                                     std::vector<NetDest>& routing_table_entry,
+                                     PortDirection src_outport,
+                                     PortDirection dst_inport)
+{
+    panic("%s: the snooping bus has no links\n", name());
+}
+
+bool
+SnoopingBusNetwork::deliver(MessageBuffer *buffer, MsgPtr msg, int vnet,
+                            Tick current_time)
+{
+    std::vector<NodeID> destinations = msg->getDestination().getAllDest();
+    assert(!destinations.empty());
+
+    // Check for resources at every destination
+    for (NodeID &dest : destinations) {
+        dest = getLocalNodeID(dest);
+        assert(m_fromNetQueues[dest].size() > vnet);
+        MessageBuffer *out = m_fromNetQueues[dest][vnet];
+        assert(out != nullptr);
+        if (!out->areNSlotsAvailable(1, current_time)) {
+            DPRINTF(RubyNetwork, "Can't deliver message since node %d "
+                    "is blocked\n", dest);
+            return false;
+        }
+    }
+
+    buffer->dequeue(msg, current_time);
+    m_pending_message_count[vnet]--;
+    if (destinations.size() > 1) {
+        busStats.broadcasts++;
+    }
+
+    // The destination set is left untouched. Each buffer records its own
+    // enqueue time and order in the message, so only the extra destinations
+    // of a broadcast get a copy.
+    for (int i = 0; i < destinations.size(); i++) {
+        MsgPtr out_msg = (i + 1 < destinations.size()) ? msg->clone() : msg;
+        DPRINTF(RubyNetwork, "Delivering msg from node %d to node %d on "
+                "vnet %d\n", buffer->getIncomingLink(), destinations[i], vnet);
+        m_fromNetQueues[destinations[i]][vnet]->enqueue(
+            out_msg, current_time, cyclesToTicks(m_transfer_latency));
+    }
+    return true;
+}
+
+void
+SnoopingBusNetwork::operateVnet(int vnet)
+{
+    if (m_pending_message_count[vnet] == 0) {
+        return;
+    }
+
+    // first check the node with the oldest message
+    std::vector<MessageBuffer*> &in = m_in[vnet];
+    unsigned start_node = 0;
+    Tick lowest_tick = MaxTick;
+    for (int i = 0; i < in.size(); i++) {
+        Tick ready_time = in[i]->readyTime();
+        if (ready_time < lowest_tick) {
+            lowest_tick = ready_time;
+            start_node = i;
+        }
+    }
+
+    Tick current_time = clockEdge();
+    for (int i = 0; i < in.size(); i++) {
+        MessageBuffer *buffer = in[(i + start_node) % in.size()];
+        while (buffer->isReady(current_time)) {
+            if (!deliver(buffer, buffer->peekMsgPtr(), vnet, current_time)) {
+                scheduleEvent(Cycles(1));
+                break;
+            }
+        }
+    }
+}
+
+void
+SnoopingBusNetwork::wakeup()
+{
+    for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+        if (vnet == m_request_bus_vnet) {
+            operateRequestBus();
+        } else if (vnet == m_response_bus_vnet) {
+            operateResponseBus();
+        } else {
+            operateVnet(vnet);
+        }
+    }
+}
+
+void
+SnoopingBusNetwork::storeEventInfo(int info)
+{
+    m_pending_message_count[info]++;
+}
+
+void
+SnoopingBusNetwork::operateRequestBus()
+{
+    uint64_t current_cycle = curCycle();
+    Tick current_time = clockEdge();
+    int num_requestors = m_req_bus_in.size();
+
+    // No wakeup is scheduled for the slots that cannot serve a waiting request,
+    // count the ones elided since the last wakeup as idle
+    if (m_req_bus_waiting && (current_cycle > m_req_bus_last_wakeup_cycle)) {
+        busStats.req_bus_idle_slots += (current_cycle - 1) / m_tdm_slot_width -
+                                       m_req_bus_last_wakeup_cycle / m_tdm_slot_width;
+    }
+    m_req_bus_last_wakeup_cycle = current_cycle;
+
+    // Search for the requestors that have a request ready
+    bool message_is_ready = false;
+    for (int i = 0; i < num_requestors; i++) {
+        m_req_bus_ready[i] = m_req_bus_in[i]->isReady(current_time);
+        message_is_ready = message_is_ready || m_req_bus_ready[i];
+    }
+
+    if (!message_is_ready) {
+        m_req_bus_waiting = false;
+        return;
+    }
+
+    // Arbitrate once per slot, at its start
+    if ((current_cycle % m_tdm_slot_width == 0) &&
+        (m_req_bus_next_free_cycle <= current_cycle)) {
+        int j = arbitrateRequestBus(current_time);
+        MessageBuffer *in_buffer = j < 0 ? nullptr : m_req_bus_in[j];
+        Tick ready_time = j < 0 ? MaxTick : in_buffer->readyTime();
+        if (j >= 0 && deliver(in_buffer, in_buffer->peekMsgPtr(),
+                              m_request_bus_vnet, current_time)) {
+            busStats.req_bus_wait[j]->sample(current_cycle -
+                                             ticksToCycles(ready_time));
+            busStats.req_bus_grants++;
+            DPRINTF(TDM, "TDM arbitration: slot owner %d sent message\n", j);
+
+            m_req_bus_ready[j] = in_buffer->isReady(current_time);
+        } else {
+            busStats.req_bus_idle_slots++;
+            DPRINTF(TDM, "TDM arbitration: slot left idle\n");
+        }
+        m_req_bus_next_free_cycle =
+            (current_cycle / m_tdm_slot_width + 1) * m_tdm_slot_width;
+    }
+    m_req_bus_waiting = std::find(m_req_bus_ready.begin(), m_req_bus_ready.end(),
+                                  true) != m_req_bus_ready.end();
+
+    // Wake up at the start of the next slot serving a waiting request, if any
+    uint64_t next_slot;
+    if (getNextServiceSlot(current_cycle / m_tdm_slot_width + 1, next_slot)) {
+        uint64_t next_slot_start_cycle = next_slot * m_tdm_slot_width;
+        assert(next_slot_start_cycle > current_cycle);
+        scheduleEvent(Cycles(next_slot_start_cycle - current_cycle));
+        DPRINTF(TDM, "TDM arbitration: next wakeup at slot %d\n", next_slot);
+    }
+}
+
+int
+SnoopingBusNetwork::getSlotOwner(uint64_t slot) const
+{
+    switch (m_tdm_arbitration) {
+      case TDMArbitration::strict:
+        return slot % m_req_bus_in.size();
+
+      case TDMArbitration::weighted:
+        return m_tdm_slot_table[slot % m_tdm_slot_table.size()];
+
+      case TDMArbitration::hybrid:
+        // The guaranteed slots come from the table, or round-robin over the critical cores
+        if (m_tdm_slot_table.empty()) {
+            return m_tdm_critical_cores[slot % m_tdm_critical_cores.size()];
+        }
+        return m_tdm_slot_table[slot % m_tdm_slot_table.size()];
+
+      default:
+        return -1;
+    }
+}
+
+int
+SnoopingBusNetwork::arbitrateRequestBus(Tick current_time)
+{
+    if (m_tdm_arbitration == TDMArbitration::work_conserving) {
+        return findReadyRequestor(current_time, false);
+    }
+
+    uint64_t slot = curCycle() / m_tdm_slot_width;
+    int owner = getSlotOwner(slot);
+    assert(owner < (int)m_req_bus_in.size());
+    if (owner >= 0 && m_req_bus_in[owner]->isReady(current_time)) {
+        return owner;
+    }
+
+    if (m_tdm_arbitration != TDMArbitration::hybrid) {
+        return -1;
+    }
+
+    // Spare slot: hand it to a best-effort core
+    owner = findReadyRequestor(current_time, true);
+    if (owner >= 0) {
+        busStats.req_bus_spare_grants++;
+    }
+    return owner;
+}
+
+bool
+SnoopingBusNetwork::getNextServiceSlot(uint64_t first_slot,
+                                       uint64_t &slot) const
+{
+    int num_requestors = m_req_bus_ready.size();
+    bool message_is_ready = false;
+    bool best_effort_is_ready = false;
+    for (int i = 0; i < num_requestors; i++) {
+        if (m_req_bus_ready[i]) {
+            message_is_ready = true;
+            if (!m_tdm_is_critical[i]) {
+                best_effort_is_ready = true;
+            }
+        }
+    }
+
+    // Every slot serves a waiting request, if any, when the idle slots are handed to the others
+    if (!message_is_ready) {
+        return false;
+    }
+    if ((m_tdm_arbitration == TDMArbitration::work_conserving) ||
+        (m_tdm_arbitration == TDMArbitration::hybrid && best_effort_is_ready)) {
+        slot = first_slot;
+        return true;
+    }
+
+    // Otherwise the first slot owned by a core with a waiting request, within a period of the schedule
+    uint64_t period;
+    if (m_tdm_arbitration == TDMArbitration::strict) {
+        period = num_requestors;
+    } else if (m_tdm_arbitration == TDMArbitration::hybrid && m_tdm_slot_table.empty()) {
+        period = m_tdm_critical_cores.size();
+    } else {
+        period = m_tdm_slot_table.size();
+    }
+    for (uint64_t k = 0; k < period; k++) {
+        int owner = getSlotOwner(first_slot + k);
+        if (owner >= 0 && owner < num_requestors && m_req_bus_ready[owner]) {
+            slot = first_slot + k;
+            return true;
+        }
+    }
+    return false;
+}
+
+int
+SnoopingBusNetwork::findReadyRequestor(Tick current_time,
+                                       bool best_effort_only)
+{
+    int j = m_request_bus_owner;
+    int num_requestors = m_req_bus_in.size();
+    for (int i = 0; i < num_requestors; i++) {
+        bool skip = best_effort_only && m_tdm_is_critical[j];
+        if (!skip && m_req_bus_in[j]->isReady(current_time)) {
+            // the round-robin restarts after the granted core
+            m_request_bus_owner = (j + 1) % num_requestors;
+            return j;
+        }
+        j = (j + 1) % num_requestors;
+    }
+    return -1;
+}
+
+void
+SnoopingBusNetwork::operateResponseBus()
+{
+    uint64_t current_cycle = curCycle();
+    if (m_resp_bus_next_free_cycle > current_cycle) {
+        return;
+    }
+
+    // The ready response that has the highest priority (i.e. lowest request ID)
+    Tick current_time = clockEdge();
+    const OldestAgeArbiter::Entry *oldest =
+        m_resp_bus_arbiter.select(current_time);
+    if (oldest == nullptr) {
+        return;
+    }
+
+    MessageBuffer *in_buffer = oldest->buffer;
+    Cycles lowest_ID = oldest->req_id;
+    if (!deliver(in_buffer, oldest->msg, m_response_bus_vnet, current_time)) {
+        scheduleEvent(Cycles(1));
+        return;
+    }
+    m_resp_bus_arbiter.pop();
+    busStats.resp_bus_grants++;
+    m_resp_bus_next_free_cycle = current_cycle + m_resp_bus_slot_width;
+
+    DPRINTF(TDM, "OA arbitration: resp bus owner %d sent response message "
+            "with reqID %d\n", in_buffer->getIncomingLink(), lowest_ID);
+    scheduleEvent(m_resp_bus_slot_width);
+}
+
+void
+SnoopingBusNetwork::print(std::ostream& out) const
+{
+    out << "[SnoopingBusNetwork]";
+}
+
+SnoopingBusNetwork::
+BusStats::BusStats(SnoopingBusNetwork *parent, int num_requestors)
+    : statistics::Group(parent, "bus"),
+      ADD_STAT(req_bus_grants, statistics::units::Count::get(),
+        "Number of request bus slots granted to a core"),
+      ADD_STAT(req_bus_idle_slots, statistics::units::Count::get(),
+        "Number of request bus slots left idle while a request was ready"),
+      ADD_STAT(req_bus_spare_grants, statistics::units::Count::get(),
+        "Number of idle slots of critical cores granted to best-effort cores"),
+      ADD_STAT(resp_bus_grants, statistics::units::Count::get(),
+        "Number of responses transmitted on the response bus"),
+      ADD_STAT(broadcasts, statistics::units::Count::get(),
+        "Number of messages delivered to more than one node")
+{
+    for (int i = 0; i < num_requestors; i++) {
+        req_bus_wait.push_back(new statistics::Histogram(this));
+        req_bus_wait[i]
+            ->init(10)
+            .name(csprintf("req_bus_wait_core%02i", i))
+            .desc("Cycles between a request being ready and its grant")
+            .flags(statistics::nozero | statistics::pdf);
+    }
+}
+
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * Ruby network of the snooping bus shared by the L1s, the LLC and the directory.
+ *
+ * Every controller is attached to the bus directly: there are no switches, links or
+ * internal buffers. A message leaves the output buffer of its sender and is enqueued in
+ * the input buffers of all its destinations after the transfer latency. The network
+ * runs on the CPU clock and the latency is in whole cycles, as the destinations only
+ * dequeue on their clock edges.
+ *
+ * Two virtual networks are arbitrated. The request bus is TDM: one request is granted
+ * per slot, according to the arbitration mode, and delivered to its destination (the
+ * requestor itself, as the grant). The response bus transmits one response at a time,
+ * the one answering the oldest request first. The other virtual networks deliver every
+ * ready message at once.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_SNOOPING_SNOOPINGBUSNETWORK_HH__
+#define __MEM_RUBY_NETWORK_SNOOPING_SNOOPINGBUSNETWORK_HH__
+
+#include <iostream>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "enums/TDMArbitration.hh"
+#include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/Network.hh"
+#include "mem/ruby/network/snooping/OldestAgeArbiter.hh"
+#include "params/SnoopingBusNetwork.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+class MessageBuffer;
+
+class SnoopingBusNetwork : public Network, public Consumer
+{
+  public:
+    typedef SnoopingBusNetworkParams Params;
+    SnoopingBusNetwork(const Params &p);
+
+    void init() override;
+
+    // The controllers are attached to the bus directly, there are no links
+    void makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
+                        std::vector<NetDest>& routing_table_entry) override;
+    void makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
+                       std::vector<NetDest>& routing_table_entry) override;
+    void makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
+                          std::vector<NetDest>& routing_table_entry,
+                          PortDirection src_outport,
+                          PortDirection dst_inport) override;
+
+    void wakeup() override;
+    void storeEventInfo(int info) override;
+
+    void collateStats() override {}
+    void print(std::ostream& out) const override;
+
+    // The messages are only held by the buffers of the controllers
+    bool functionalRead(Packet *pkt) override { return false; }
+    bool functionalRead(Packet *pkt, WriteMask& mask) override { return false; }
+    uint32_t functionalWrite(Packet *pkt) override { return 0; }
+
+  private:
+    // Output buffers of the nodes on a virtual network, in node order
+    std::vector<MessageBuffer*> getToNetQueues(int vnet) const;
+    // Send the given message of the buffer to all its destinations,
+    // false if one of them has no space left
+    bool deliver(MessageBuffer *buffer, MsgPtr msg, int vnet,
+                 Tick current_time);
+    // Deliver every ready message of a virtual network without arbitration
+    void operateVnet(int vnet);
+
+    // Request bus
+    void operateRequestBus();
+    // Owner core of a slot of the strict, weighted and hybrid schedules, -1 for none
+    int getSlotOwner(uint64_t slot) const;
+    // Core granted the current slot, -1 if the slot is left idle
+    int arbitrateRequestBus(Tick current_time);
+    // First slot from first_slot granted to one of the ready requests,
+    // false if none of them will be granted a slot
+    bool getNextServiceSlot(uint64_t first_slot, uint64_t &slot) const;
+    // First core with a request ready, round-robin from m_request_bus_owner
+    int findReadyRequestor(Tick current_time, bool best_effort_only);
+
+    // Response bus
+    void operateResponseBus();
+
+    const int m_request_bus_vnet;
+    const int m_response_bus_vnet;
+    const Cycles m_tdm_slot_width;
+    const Cycles m_resp_bus_slot_width;
+    const TDMArbitration m_tdm_arbitration;
+    // Owner core of each slot of the weighted and hybrid schedules, -1 for none
+    const std::vector<int> m_tdm_slot_table;
+    const std::vector<int> m_tdm_critical_cores;
+    const Cycles m_transfer_latency;
+
+    // Output buffers of the nodes, indexed by vnet
+    std::vector<std::vector<MessageBuffer*>> m_in;
+    std::vector<int> m_pending_message_count;
+
+    // Output buffers of the requestors on the request bus, the cores first
+    std::vector<MessageBuffer*> m_req_bus_in;
+    std::vector<bool> m_tdm_is_critical;
+    int m_request_bus_owner = 0;
+    uint64_t m_req_bus_next_free_cycle = 0;
+    uint64_t m_req_bus_last_wakeup_cycle = 0;
+    // A request was waiting after the last wakeup
+    bool m_req_bus_waiting = false;
+    // Requestors with a request ready, at the last wakeup
+    std::vector<bool> m_req_bus_ready;
+
+    uint64_t m_resp_bus_next_free_cycle = 0;
+    OldestAgeArbiter m_resp_bus_arbiter;
+
+    struct BusStats : public statistics::Group
+    {
+        BusStats(SnoopingBusNetwork *parent, int num_requestors);
+
+        statistics::Scalar req_bus_grants;
+        statistics::Scalar req_bus_idle_slots;
+        statistics::Scalar req_bus_spare_grants;
+        statistics::Scalar resp_bus_grants;
+        statistics::Scalar broadcasts;
+        // Cycles between a request being ready and its grant, per core
+        std::vector<statistics::Histogram *> req_bus_wait;
+    } busStats;
+};
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_SNOOPING_SNOOPINGBUSNETWORK_HH__
@@ -0,0 +1,35 @@
+from m5.params import *
+
+from m5.objects.Network import RubyNetwork
+
+# Arbitration of the slots of the request bus.
+# 'strict': slot i belongs to core i mod the number of cores and is left idle if
+# the core has no request. 'work_conserving': a slot goes to the first core with
+# a request, round-robin from the core after the last granted one. 'weighted':
+# slot i belongs to tdm_slot_table[i mod len(tdm_slot_table)] (-1 for no core).
+# 'hybrid': the slots of the table (or round-robin over tdm_critical_cores if
+# the table is empty) are guaranteed to their critical core and the slots they
+# leave idle go round-robin to the other, best-effort, cores.
+class TDMArbitration(ScopedEnum):
+    vals = ['strict', 'work_conserving', 'weighted', 'hybrid']
+
+class SnoopingBusNetwork(RubyNetwork):
+    type = 'SnoopingBusNetwork'
+    cxx_header = "mem/ruby/network/snooping/SnoopingBusNetwork.hh"
+    cxx_class = 'gem5::ruby::SnoopingBusNetwork'
+
+    request_bus_vnet = Param.Int(0, "Virtual network of the request bus, the "
+                                    "nodes sending on it are its requestors, "
+                                    "the cores first")
+    response_bus_vnet = Param.Int(2, "Virtual network of the response bus")
+    tdm_slot_width = Param.Cycles(3, "TDM slot width of the request bus")
+    resp_bus_slot_width = Param.Cycles(3, "The number of busy cycles to "
+                                          "transmit a response on the response bus")
+    tdm_arbitration = Param.TDMArbitration('work_conserving',
+                                           "Arbitration of the request bus slots")
+    tdm_slot_table = VectorParam.Int([], "Owner core of each slot of the weighted "
+                                         "and hybrid schedules (-1 for none)")
+    tdm_critical_cores = VectorParam.Int([], "Cores guaranteed their slots in the "
+                                             "hybrid schedule")
+    transfer_latency = Param.Cycles(1, "The number of cycles for a message on "
+                                       "the bus to reach its destinations")
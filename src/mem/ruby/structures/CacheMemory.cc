@@ -51,6 +51,7 @@
 #include "debug/RubyStats.hh"
 #include "mem/cache/replacement_policies/weighted_lru_rp.hh"
 #include "mem/cache/replacement_policies/par_rp.hh"
+#include "mem/cache/replacement_policies/par_ucp.hh"
 #include "mem/ruby/protocol/AccessPermission.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
@@ -85,6 +86,19 @@ CacheMemory::CacheMemory(const Params &p)
     m_block_size = p.block_size;  // may be 0 at this point. Updated in init()
     m_use_occupancy = dynamic_cast<replacement_policy::WeightedLRU*>(
                                     m_replacementPolicy_ptr) ? true : false;
+    replacement_policy::Par* par_policy =
+        dynamic_cast<replacement_policy::Par*>(m_replacementPolicy_ptr);
+    m_use_way_mask = par_policy != nullptr && par_policy->isWayMaskMode();
+    m_num_colors = p.num_colors;
+    fatal_if(m_num_colors < 0, "The number of page colors must not be negative.");
+    // without colored pages, every line would map to the sets of color 0
+    fatal_if(m_num_colors > 0 && !p.page_coloring,
+        "Page colors need a cache controller that colors the pages "
+        "(page_coloring), such as the MSI LLC.");
+    fatal_if(!isPowerOf2(p.color_page_size),
+        "The page coloring granularity must be a power of 2.");
+    m_color_page_bits = floorLog2(p.color_page_size);
+    m_color_num_set_bits = 0;
 }
 
 void
@@ -97,6 +111,12 @@ CacheMemory::init()
     assert(m_cache_num_sets > 1);
     m_cache_num_set_bits = floorLog2(m_cache_num_sets);
     assert(m_cache_num_set_bits > 0);
+    if (m_num_colors > 0) {
+        fatal_if(!isPowerOf2(m_num_colors) || m_num_colors > m_cache_num_sets,
+            "The number of page colors must be a power of 2 and at most the "
+            "number of sets (%d).", m_cache_num_sets);
+        m_color_num_set_bits = m_cache_num_set_bits - floorLog2(m_num_colors);
+    }
 
     m_cache.resize(m_cache_num_sets,
                     std::vector<AbstractCacheEntry*>(m_cache_assoc, nullptr));
@@ -128,6 +148,16 @@ int64_t
 CacheMemory::addressToCacheSet(Addr address) const
 {
     assert(address == makeLineAddress(address));
+    if (m_num_colors > 0) {
+        // the lines of a page without a color are not in the cache,
+        // so any color does for their lookups
+        auto it = m_page_color.find(address >> m_color_page_bits);
+        int64_t color = it != m_page_color.end() ? it->second : 0;
+        int64_t set_in_color = m_color_num_set_bits == 0 ? 0 :
+            bitSelect(address, m_start_index_bit,
+                      m_start_index_bit + m_color_num_set_bits - 1);
+        return (color << m_color_num_set_bits) | set_in_color;
+    }
     return bitSelect(address, m_start_index_bit,
                      m_start_index_bit + m_cache_num_set_bits - 1);
 }
@@ -135,9 +165,22 @@ CacheMemory::addressToCacheSet(Addr address) const
 Addr
 CacheMemory::addressToCacheSetUnsigned(Addr address) const
 {
-    assert(address == makeLineAddress(address));
-    return bitSelect(address, m_start_index_bit,
-                     m_start_index_bit + m_cache_num_set_bits - 1);
+    return addressToCacheSet(address);
+}
+
+void
+CacheMemory::colorPage(Addr address, int par_id)
+{
+    if (m_num_colors == 0) {
+        return;
+    }
+    assert(par_id >= 0);
+    Addr page = address >> m_color_page_bits;
+    if (m_page_color.emplace(page, par_id % m_num_colors).second) {
+        DPRINTF(RubyCache, "colorPage: page 0x%x gets color %d\n",
+                page << m_color_page_bits, par_id % m_num_colors);
+        cacheMemoryStats.m_colored_pages++;
+    }
 }
 
 // Given a cache index: returns the index of the tag in a set.
@@ -260,6 +303,15 @@ CacheMemory::cacheAvail(Addr address) const
 
     int64_t cacheSet = addressToCacheSet(address);
 
+    // with way masks, the partition victims of the set are replaced
+    // before any new line is allocated
+    if (m_use_way_mask && !isTagPresent(address) &&
+        !static_cast<replacement_policy::Par*>(
+            m_replacementPolicy_ptr)->phyAvail(
+            replacement_data[cacheSet][0])) {
+        return false;
+    }
+
     for (int i = 0; i < m_cache_assoc; i++) {
         AbstractCacheEntry* entry = m_cache[cacheSet][i];
         if (entry != NULL) {
@@ -331,6 +383,17 @@ CacheMemory::isParHit(Addr address, int par_id) const {
     return res;
 }
 
+int
+CacheMemory::getReclaimPar(Addr address) const {
+    assert(address == makeLineAddress(address));
+    const AbstractCacheEntry* entry = lookup(address);
+    assert(entry != nullptr);
+    int res = static_cast<replacement_policy::Par*>(
+                m_replacementPolicy_ptr)->reclaimPar(
+                entry->replacementData);
+    return res;
+}
+
 AbstractCacheEntry*
 CacheMemory::allocate(Addr address, AbstractCacheEntry *entry)
 {
@@ -385,6 +448,13 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry, int par_id)
     int64_t cacheSet = addressToCacheSet(address);
     std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
     for (int i = 0; i < m_cache_assoc; i++) {
+        // with way masks, only allocate in the ways of the partition
+        if (m_use_way_mask &&
+            !static_cast<replacement_policy::Par*>(
+                m_replacementPolicy_ptr)->parAllowed(
+                replacement_data[cacheSet][i], par_id)) {
+            continue;
+        }
         if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
             if (set[i] && (set[i] != entry)) {
                 warn_once("This protocol contains a cache entry handling bug: "
@@ -532,6 +602,14 @@ CacheMemory::setMRU(AbstractCacheEntry *entry, int par_id)
     assert(entry != nullptr);
     m_replacementPolicy_ptr->touch(entry->replacementData, par_id);
     entry->setLastAccess(curTick());
+
+    replacement_policy::ParUtilityMonitor* monitor =
+        static_cast<replacement_policy::Par*>(
+            m_replacementPolicy_ptr)->getUtilityMonitor();
+    if (monitor != nullptr) {
+        monitor->access(addressToCacheSet(entry->m_Address),
+                        entry->m_Address, par_id);
+    }
 }
 
 void
@@ -700,7 +778,8 @@ CacheMemoryStats::CacheMemoryStats(statistics::Group *parent)
       ADD_STAT(m_prefetch_misses, "Number of cache prefetch misses"),
       ADD_STAT(m_prefetch_accesses, "Number of cache prefetch accesses",
                m_prefetch_hits + m_prefetch_misses),
-      ADD_STAT(m_accessModeType, "")
+      ADD_STAT(m_accessModeType, ""),
+      ADD_STAT(m_colored_pages, "Number of pages colored on first touch")
 {
     numDataArrayReads
         .flags(statistics::nozero);
@@ -759,6 +838,9 @@ CacheMemoryStats::CacheMemoryStats(statistics::Group *parent)
             .flags(statistics::nozero)
             ;
     }
+
+    m_colored_pages
+        .flags(statistics::nozero);
 }
 
 // assumption: SLICC generated files will only call this function
@@ -103,6 +103,14 @@ class CacheMemory : public SimObject
     // check if the address is in a partition
     bool isParHit(Addr address, int par_id) const;
 
+    // return the partition to remove the address from before it can be replaced,
+    // -1 if the address is not in any partition
+    int getReclaimPar(Addr address) const;
+
+    // give the page of the address the color of the partition if the page has
+    // no color yet (first touch), no-op if set partitioning is disabled
+    void colorPage(Addr address, int par_id);
+
     // Returns a NULL entry that acts as a placeholder for invalid lines
     AbstractCacheEntry*
     getNullEntry() const
@@ -227,6 +235,25 @@ class CacheMemory : public SimObject
      */
     bool m_use_occupancy;
 
+    /**
+     * Set to true when the partitioned replacement policy restricts the
+     * allocations of each partition to a way mask, otherwise, set to false.
+     */
+    bool m_use_way_mask;
+
+    /**
+     * Set partitioning (page coloring): the sets are split evenly between
+     * m_num_colors colors, 0 disables it. A page gets the color of the first
+     * partition that touches it, as under first-touch page coloring in the
+     * OS, and keeps it until the end of the simulation. Within its color, a
+     * line is indexed by the low bits of the regular set index. It requires
+     * a controller that colors the pages, which sets page_coloring.
+     */
+    int m_num_colors;
+    int m_color_num_set_bits;
+    int m_color_page_bits;
+    std::unordered_map<Addr, int> m_page_color;
+
     private:
       struct CacheMemoryStats : public statistics::Group
       {
@@ -255,6 +282,8 @@ class CacheMemory : public SimObject
           statistics::Formula m_prefetch_accesses;
 
           statistics::Vector m_accessModeType;
+
+          statistics::Scalar m_colored_pages;
       } cacheMemoryStats;
 
     public:
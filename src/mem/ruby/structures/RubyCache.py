@@ -40,6 +40,11 @@ class RubyCache(SimObject):
     start_index_bit = Param.Int(6, "index start, default 6 for 64-byte line");
     is_icache = Param.Bool(False, "is instruction only cache");
     block_size = Param.MemorySize("0B", "block size in bytes. 0 means default RubyBlockSize")
+    num_colors = Param.Int(0, "number of page colors the sets are split between, "
+                              "0 disables set partitioning")
+    color_page_size = Param.MemorySize("4kB", "page coloring granularity")
+    page_coloring = Param.Bool(False, "the controller colors the pages on first "
+                                      "touch (colorPage), required by num_colors")
 
     dataArrayBanks = Param.Int(1, "Number of banks for the data array")
     tagArrayBanks = Param.Int(1, "Number of banks for the tag array")
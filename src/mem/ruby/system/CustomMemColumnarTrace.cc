@@ -0,0 +1,208 @@
+#include "mem/ruby/system/CustomMemColumnarTrace.hh"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstring>
+
+#include "base/logging.hh"
+#include "mem/ruby/system/CustomMemProbe.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace
+{
+
+void
+putVarint(std::vector<uint8_t> &column, uint64_t value)
+{
+    while (value >= 0x80) {
+        column.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    column.push_back(value);
+}
+
+uint64_t
+zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+void
+putU32(std::vector<uint8_t> &buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        buffer.push_back(value >> (8 * i));
+    }
+}
+
+} // anonymous namespace
+
+CustomMemColumnarTraceWriter::CustomMemColumnarTraceWriter(
+        const std::string &filename, int line_bits, bool compress)
+    : m_file_offset(0),
+      m_line_bits(line_bits),
+      m_compress(compress),
+      m_num_block_records(0),
+      m_num_records(0),
+      m_last_line(0),
+      m_bb_id_run_value(0),
+      m_bb_id_run_length(0),
+      m_thread_id_run_value(0),
+      m_thread_id_run_length(0)
+{
+    m_file = fopen(filename.c_str(), "wb");
+    fatal_if(m_file == nullptr, "Failed to open columnar trace file %s.", filename);
+    writeBytes("OMPTRCT1", 8);
+    writeU32(m_line_bits);
+    writeU32(m_compress ? 1 : 0);
+}
+
+CustomMemColumnarTraceWriter::~CustomMemColumnarTraceWriter()
+{
+    flushBlock();
+
+    uint64_t bb_metadata_offset = m_file_offset;
+    for (const BBMetadata &bb_metadata : m_bb_metadata) {
+        writeU32(bb_metadata.bb_id);
+        writeU32(bb_metadata.thread_id);
+        writeU64(bb_metadata.exec_cycles);
+    }
+
+    uint64_t block_index_offset = m_file_offset;
+    for (const BlockIndexEntry &entry : m_block_index) {
+        writeU64(entry.offset);
+        writeU64(entry.first_record);
+        writeU32(entry.num_records);
+    }
+
+    writeU64(bb_metadata_offset);
+    writeU64(m_bb_metadata.size());
+    writeU64(block_index_offset);
+    writeU64(m_block_index.size());
+    writeBytes("OMPTRCTE", 8);
+    fclose(m_file);
+}
+
+void
+CustomMemColumnarTraceWriter::write(const CustomMemTrace &mem_trace, int bb_id)
+{
+    // the first record of a block is encoded against line 0,
+    // so that blocks can be decoded independently
+    Addr line = mem_trace.line_address >> m_line_bits;
+    putVarint(m_columns[LINE_ADDRESS], zigzag((int64_t)(line - m_last_line)));
+    m_last_line = line;
+
+    assert(mem_trace.address >= mem_trace.line_address);
+    putVarint(m_columns[LINE_OFFSET], mem_trace.address - mem_trace.line_address);
+
+    if (m_bb_id_run_length != 0 && bb_id != m_bb_id_run_value) {
+        putVarint(m_columns[BB_ID], zigzag(m_bb_id_run_value));
+        putVarint(m_columns[BB_ID], m_bb_id_run_length);
+        m_bb_id_run_length = 0;
+    }
+    m_bb_id_run_value = bb_id;
+    m_bb_id_run_length++;
+
+    if (m_thread_id_run_length != 0 && mem_trace.thread_id != m_thread_id_run_value) {
+        putVarint(m_columns[THREAD_ID], zigzag(m_thread_id_run_value));
+        putVarint(m_columns[THREAD_ID], m_thread_id_run_length);
+        m_thread_id_run_length = 0;
+    }
+    m_thread_id_run_value = mem_trace.thread_id;
+    m_thread_id_run_length++;
+
+    m_columns[FLAGS].push_back(mem_trace.access_type |
+                               (mem_trace.hit_status << 2) |
+                               (mem_trace.data_region << 4));
+
+    if (++m_num_block_records == blockCapacity) {
+        flushBlock();
+    }
+}
+
+void
+CustomMemColumnarTraceWriter::writeExecCycles(int bb_id, int thread_id, uint64_t exec_cycles)
+{
+    m_bb_metadata.push_back({bb_id, thread_id, exec_cycles});
+}
+
+void
+CustomMemColumnarTraceWriter::flushBlock()
+{
+    if (m_num_block_records == 0) {
+        return;
+    }
+
+    // close the current runs
+    putVarint(m_columns[BB_ID], zigzag(m_bb_id_run_value));
+    putVarint(m_columns[BB_ID], m_bb_id_run_length);
+    m_bb_id_run_length = 0;
+    putVarint(m_columns[THREAD_ID], zigzag(m_thread_id_run_value));
+    putVarint(m_columns[THREAD_ID], m_thread_id_run_length);
+    m_thread_id_run_length = 0;
+
+    m_payload.clear();
+    putU32(m_payload, m_num_block_records);
+    for (std::vector<uint8_t> &column : m_columns) {
+        putU32(m_payload, column.size());
+        m_payload.insert(m_payload.end(), column.begin(), column.end());
+        column.clear();
+    }
+
+    const uint8_t *stored = m_payload.data();
+    uLongf stored_size = m_payload.size();
+    if (m_compress) {
+        m_stored.resize(compressBound(m_payload.size()));
+        stored_size = m_stored.size();
+        int ret = compress2(m_stored.data(), &stored_size, m_payload.data(),
+                            m_payload.size(), Z_BEST_SPEED);
+        fatal_if(ret != Z_OK, "Failed to compress a columnar trace block.");
+        stored = m_stored.data();
+    }
+
+    m_block_index.push_back({m_file_offset, m_num_records, m_num_block_records});
+    writeU32(stored_size);
+    writeU32(m_payload.size());
+    writeBytes(stored, stored_size);
+
+    m_num_records += m_num_block_records;
+    m_num_block_records = 0;
+    m_last_line = 0;
+}
+
+void
+CustomMemColumnarTraceWriter::writeBytes(const void *data, size_t size)
+{
+    fatal_if(fwrite(data, 1, size, m_file) != size,
+             "Failed to write the columnar trace.");
+    m_file_offset += size;
+}
+
+void
+CustomMemColumnarTraceWriter::writeU32(uint32_t value)
+{
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = value >> (8 * i);
+    }
+    writeBytes(bytes, 4);
+}
+
+void
+CustomMemColumnarTraceWriter::writeU64(uint64_t value)
+{
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = value >> (8 * i);
+    }
+    writeBytes(bytes, 8);
+}
+
+} // namespace ruby
+} // namespace gem5
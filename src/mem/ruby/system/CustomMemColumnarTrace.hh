@@ -0,0 +1,114 @@
+/**
+ * @file
+ * Columnar binary format of the raw memory traces of the CustomMemProbe,
+ * a compact alternative to one protobuf message per memory access.
+ *
+ * Records are buffered in blocks of up to blockCapacity records, and each block
+ * stores every field of its records in a separate column:
+ * - line address: zigzag varint of the delta (in lines) to the previous line address of the block,
+ * - line offset: varint of address - line address,
+ * - bb_id: runs of (zigzag varint bb_id, varint run length),
+ * - thread_id: runs of (zigzag varint thread_id, varint run length),
+ * - flags: one byte per record, access type | hit status << 2 | data region << 4.
+ *
+ * File layout, integers are little endian:
+ * - header: magic "OMPTRCT1", u32 line size bits, u32 flags (bit 0: block payloads are zlib-compressed),
+ * - blocks: u32 stored payload size, u32 payload size, payload
+ *   (payload: u32 number of records, then for every column u32 column size and the column),
+ * - bb metadata: (i32 bb_id, i32 thread_id, u64 exec cycles) per ended basic block,
+ * - block index: (u64 file offset, u64 first record, u32 number of records) per block,
+ * - footer: u64 bb metadata offset, u64 number of bb metadata, u64 block index offset,
+ *   u64 number of blocks, magic "OMPTRCTE".
+ *
+ * The reader used by the analyzer is omptr/analyzer/columnar_trace.hh.
+ */
+
+#ifndef __MEM_RUBY_SYSTEM_CUSTOMMEMCOLUMNARTRACE_HH__
+#define __MEM_RUBY_SYSTEM_CUSTOMMEMCOLUMNARTRACE_HH__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+struct CustomMemTrace;
+
+class CustomMemColumnarTraceWriter
+{
+    public:
+        /** Number of records per block. */
+        static const uint32_t blockCapacity = 65536;
+
+        CustomMemColumnarTraceWriter(const std::string &filename, int line_bits, bool compress);
+
+        /** Flush the last block and write the bb metadata, the block index and the footer. */
+        ~CustomMemColumnarTraceWriter();
+
+        void write(const CustomMemTrace &mem_trace, int bb_id);
+
+        void writeExecCycles(int bb_id, int thread_id, uint64_t exec_cycles);
+
+    private:
+        enum Column {
+            LINE_ADDRESS,
+            LINE_OFFSET,
+            BB_ID,
+            THREAD_ID,
+            FLAGS,
+            NUM_COLUMNS
+        };
+
+        struct BlockIndexEntry {
+            uint64_t offset;
+            uint64_t first_record;
+            uint32_t num_records;
+        };
+
+        struct BBMetadata {
+            int bb_id;
+            int thread_id;
+            uint64_t exec_cycles;
+        };
+
+        FILE *m_file;
+        uint64_t m_file_offset;
+        const int m_line_bits;
+        const bool m_compress;
+
+        /** Columns of the current block. */
+        std::vector<uint8_t> m_columns[NUM_COLUMNS];
+        uint32_t m_num_block_records;
+        uint64_t m_num_records;
+        Addr m_last_line;
+
+        /** Current runs of the run-length encoded columns. */
+        int m_bb_id_run_value;
+        uint64_t m_bb_id_run_length;
+        int m_thread_id_run_value;
+        uint64_t m_thread_id_run_length;
+
+        std::vector<BlockIndexEntry> m_block_index;
+        std::vector<BBMetadata> m_bb_metadata;
+
+        /** Scratch buffers, kept to avoid allocations per block. */
+        std::vector<uint8_t> m_payload;
+        std::vector<uint8_t> m_stored;
+
+        void flushBlock();
+        void writeBytes(const void *data, size_t size);
+        void writeU32(uint32_t value);
+        void writeU64(uint64_t value);
+};
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_SYSTEM_CUSTOMMEMCOLUMNARTRACE_HH__
@@ -0,0 +1,480 @@
+#include "mem/ruby/system/CustomMemOnlineClassifier.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+#include "base/logging.hh"
+#include "mem/ruby/system/CustomMemProbe.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace
+{
+
+// LLC management configurations and access categories, as in omptr/analyzer/analyzer.hh
+enum Config {
+    SHARE,
+    COLOR,
+    PAR,
+    COLOR_PRIVATE_INST,
+    NUM_CONFIGS
+};
+
+const char *const configNames[NUM_CONFIGS] = {"SHARE", "COLOR", "PAR", "COLOR_PRIVATE_INST"};
+
+enum AccessCategory {
+    PRIVATE_INST,
+    SHARED_INST,
+    PRIVATE_DATA,
+    SHARED_DATA,
+    NUM_ACCESS_CATEGORIES
+};
+
+const int numHitLevels = 3;
+
+/**
+ * WCL of an access by category and level that served it in a configuration,
+ * see sweep_coefficients() of the analyzer.
+ */
+void
+configCoefficients(Config config, uint64_t wcl_l1, uint64_t wcl_llc, uint64_t wcl_mem,
+                   uint64_t coefficients[NUM_ACCESS_CATEGORIES][numHitLevels])
+{
+    const uint64_t isolated[numHitLevels] = {wcl_l1, wcl_llc, wcl_mem};
+    const uint64_t unisolated[numHitLevels] = {wcl_mem, wcl_mem, wcl_mem};
+    const uint64_t shared_partition[numHitLevels] = {wcl_llc, wcl_llc, wcl_mem};
+    const uint64_t *wcls[NUM_ACCESS_CATEGORIES];
+    switch (config) {
+        case SHARE:
+            wcls[PRIVATE_INST] = unisolated;
+            wcls[SHARED_INST] = unisolated;
+            wcls[PRIVATE_DATA] = unisolated;
+            wcls[SHARED_DATA] = unisolated;
+            break;
+        case COLOR:
+            wcls[PRIVATE_INST] = isolated;
+            wcls[SHARED_INST] = unisolated;
+            wcls[PRIVATE_DATA] = isolated;
+            wcls[SHARED_DATA] = unisolated;
+            break;
+        case PAR:
+            wcls[PRIVATE_INST] = isolated;
+            wcls[SHARED_INST] = isolated;
+            wcls[PRIVATE_DATA] = isolated;
+            wcls[SHARED_DATA] = shared_partition;
+            break;
+        default:
+            wcls[PRIVATE_INST] = isolated;
+            wcls[SHARED_INST] = isolated;
+            wcls[PRIVATE_DATA] = isolated;
+            wcls[SHARED_DATA] = unisolated;
+            break;
+    }
+    for (int i = 0; i < NUM_ACCESS_CATEGORIES; ++i) {
+        for (int j = 0; j < numHitLevels; ++j) {
+            coefficients[i][j] = wcls[i][j];
+        }
+    }
+}
+
+} // anonymous namespace
+
+CustomMemOnlineClassifier::CustomMemOnlineClassifier()
+{
+    // basic block 0 of task 0, the root of the DAG
+    Task root;
+    root.parent = -1;
+    root.creator_node = -1;
+    root.creator_seg = -1;
+    root.depth = 0;
+    m_tasks.push_back(root);
+    addBB(0, 0, 0, 0);
+}
+
+void
+CustomMemOnlineClassifier::defaultWCLs(int num_cores, uint64_t &wcl_l1, uint64_t &wcl_llc,
+                                       uint64_t &wcl_mem)
+{
+    // default_wcls() of the analyzer
+    if (num_cores == 2) {
+        wcl_l1 = 1;
+        wcl_llc = 87;
+        wcl_mem = 568;
+    } else if (num_cores == 4) {
+        wcl_l1 = 1;
+        wcl_llc = 175;
+        wcl_mem = 1063;
+    } else {
+        wcl_l1 = 1;
+        wcl_llc = 431;
+        wcl_mem = 2065;
+    }
+}
+
+CustomMemOnlineClassifier::BasicBlock &
+CustomMemOnlineClassifier::getBB(int bb_id)
+{
+    fatal_if(bb_id < 0 || bb_id >= m_bbs.size() || m_bbs[bb_id].task == -1,
+             "BB %d is not in the DAG, is the program built with -DOMPTR_ONLINE?\n", bb_id);
+    return m_bbs[bb_id];
+}
+
+void
+CustomMemOnlineClassifier::addBB(int bb_id, int task, int node, int seg)
+{
+    assert(bb_id >= 0);
+    if (bb_id >= m_bbs.size()) {
+        BasicBlock unknown;
+        unknown.task = -1;
+        unknown.node = -1;
+        unknown.seg = -1;
+        unknown.thread_id = -1;
+        unknown.exec_cycles = 0;
+        m_bbs.resize(bb_id + 1, unknown);
+    }
+    BasicBlock &bb = m_bbs[bb_id];
+    fatal_if(bb.task != -1, "BB %d is created twice\n", bb_id);
+    bb.task = task;
+    bb.node = node;
+    bb.seg = seg;
+
+    Task &t = m_tasks[task];
+    assert(node == t.bbs.size());
+    t.bbs.push_back(bb_id);
+    if (seg == t.seg_first_bb.size()) {
+        t.seg_first_bb.push_back(bb_id);
+    }
+}
+
+void
+CustomMemOnlineClassifier::fork(int bb_id, int child_bb_id, int next_bb_id)
+{
+    BasicBlock bb = getBB(bb_id);
+    fatal_if(bb.node + 1 != m_tasks[bb.task].bbs.size(),
+             "BB %d creates a task but is not the last BB of its task\n", bb_id);
+
+    int child_task = m_tasks.size();
+    Task child;
+    child.parent = bb.task;
+    child.creator_node = bb.node;
+    child.creator_seg = bb.seg;
+    child.depth = m_tasks[bb.task].depth + 1;
+    m_tasks.push_back(child);
+    m_tasks[bb.task].children.push_back(child_task);
+
+    addBB(child_bb_id, child_task, 0, 0);
+    addBB(next_bb_id, bb.task, bb.node + 1, bb.seg);
+}
+
+void
+CustomMemOnlineClassifier::join(int bb_id, int next_bb_id)
+{
+    BasicBlock bb = getBB(bb_id);
+    fatal_if(bb.node + 1 != m_tasks[bb.task].bbs.size(),
+             "BB %d waits for tasks but is not the last BB of its task\n", bb_id);
+
+    // the children created in the segment of bb are joined by next_bb_id
+    addBB(next_bb_id, bb.task, bb.node + 1, bb.seg + 1);
+}
+
+void
+CustomMemOnlineClassifier::commonTask(int u, int v, Position &pu, Position &pv) const
+{
+    const BasicBlock &bu = m_bbs[u];
+    const BasicBlock &bv = m_bbs[v];
+    pu = {bu.task, bu.node, bu.seg, false, true};
+    pv = {bv.task, bv.node, bv.seg, false, true};
+
+    // replace the position in a task by the position of its creator in the parent task
+    auto lift = [this](Position &p) {
+        const Task &t = m_tasks[p.task];
+        const Task &parent = m_tasks[t.parent];
+        p.task = t.parent;
+        p.node = t.creator_node;
+        p.seg = t.creator_seg;
+        p.lifted = true;
+        // the task is joined iff its parent has a taskwait after creating it
+        p.joined = p.joined && t.creator_seg + 1 < parent.seg_first_bb.size();
+    };
+    while (m_tasks[pu.task].depth > m_tasks[pv.task].depth) {
+        lift(pu);
+    }
+    while (m_tasks[pv.task].depth > m_tasks[pu.task].depth) {
+        lift(pv);
+    }
+    while (pu.task != pv.task) {
+        lift(pu);
+        lift(pv);
+    }
+}
+
+bool
+CustomMemOnlineClassifier::reaches(const Position &pu, const Position &pv)
+{
+    if (pu.lifted) {
+        // u is in a child task, joined by the first taskwait after its creation,
+        // a child task that is never waited for does not reach its parent task again
+        return pu.joined && pu.seg < pv.seg;
+    }
+    // u is in the common task, it reaches the later basic blocks and the tasks they create
+    return pu.node < pv.node || (pv.lifted && pu.node == pv.node);
+}
+
+bool
+CustomMemOnlineClassifier::reaches(int u, int v) const
+{
+    if (u == v) {
+        return false;
+    }
+    Position pu, pv;
+    commonTask(u, v, pu, pv);
+    return reaches(pu, pv);
+}
+
+bool
+CustomMemOnlineClassifier::parallel(int u, int v) const
+{
+    if (u == v) {
+        return false;
+    }
+    Position pu, pv;
+    commonTask(u, v, pu, pv);
+    return !reaches(pu, pv) && !reaches(pv, pu);
+}
+
+void
+CustomMemOnlineClassifier::record(const AddrAccessStats &stats)
+{
+    if (stats.is_metadata) {
+        return;
+    }
+    BasicBlock &bb = getBB(stats.bb_id);
+    fatal_if(bb.thread_id != -1 && bb.thread_id != stats.thread_id,
+             "BB %d runs on threads %d and %d\n", stats.bb_id, bb.thread_id, stats.thread_id);
+    bb.thread_id = stats.thread_id;
+
+    fatal_if(m_accessors.size() == noAccessor, "Too many line accessors\n");
+    uint32_t index = m_accessors.size();
+    Accessor a;
+    a.bb_id = stats.bb_id;
+    a.thread_id = stats.thread_id;
+    a.is_ifetch = stats.is_ifetch;
+    a.is_shared = false;
+    a.counters[L1_HIT] = stats.num_local_l1_hit;
+    a.counters[LLC_HIT] = stats.num_remote_l1_hit + stats.num_l2_hit;
+    a.counters[MEMORY_ACCESS] = stats.num_memory_access;
+
+    auto exempt = [&a](const Accessor &b) {
+        return !a.is_ifetch && !b.is_ifetch && a.thread_id == b.thread_id;
+    };
+
+    auto it = m_lines.find(stats.line_address);
+    if (it == m_lines.end()) {
+        it = m_lines.emplace(stats.line_address, LineAccessors{noAccessor, noAccessor}).first;
+    }
+    LineAccessors &line = it->second;
+
+    // the private accessors parallel to the new one become shared
+    uint32_t *link = &line.private_head;
+    while (*link != noAccessor) {
+        uint32_t i = *link;
+        Accessor &b = m_accessors[i];
+        if (!exempt(b) && parallel(a.bb_id, b.bb_id)) {
+            a.is_shared = true;
+            b.is_shared = true;
+            *link = b.next;
+            b.next = line.shared_head;
+            line.shared_head = i;
+        } else {
+            link = &b.next;
+        }
+    }
+    // otherwise the new accessor only needs one parallel shared accessor
+    for (uint32_t i = line.shared_head; !a.is_shared && i != noAccessor; i = m_accessors[i].next) {
+        const Accessor &b = m_accessors[i];
+        if (!exempt(b) && parallel(a.bb_id, b.bb_id)) {
+            a.is_shared = true;
+        }
+    }
+
+    uint32_t &head = a.is_shared ? line.shared_head : line.private_head;
+    a.next = head;
+    head = index;
+    m_accessors.push_back(a);
+}
+
+void
+CustomMemOnlineClassifier::recordExecCycles(int bb_id, int thread_id, uint64_t exec_cycles)
+{
+    BasicBlock &bb = getBB(bb_id);
+    bb.thread_id = thread_id;
+    bb.exec_cycles = exec_cycles;
+}
+
+void
+CustomMemOnlineClassifier::buildDAG(std::vector<std::vector<int>> &succ) const
+{
+    succ.assign(m_bbs.size(), std::vector<int>());
+    int num_unjoined = 0;
+    for (const Task &t : m_tasks) {
+        // control flow edges
+        for (size_t i = 1; i < t.bbs.size(); ++i) {
+            succ[t.bbs[i - 1]].push_back(t.bbs[i]);
+        }
+        for (int c : t.children) {
+            const Task &child = m_tasks[c];
+            // task creation edge
+            succ[t.bbs[child.creator_node]].push_back(child.bbs.front());
+            // synchronization edge
+            if (child.creator_seg + 1 < t.seg_first_bb.size()) {
+                succ[child.bbs.back()].push_back(t.seg_first_bb[child.creator_seg + 1]);
+            } else {
+                num_unjoined++;
+            }
+        }
+    }
+    warn_if(num_unjoined > 0, "%d omptr tasks are never waited for\n", num_unjoined);
+}
+
+void
+CustomMemOnlineClassifier::write(const std::string &prefix, int num_cores,
+                                 uint64_t wcl_l1, uint64_t wcl_llc, uint64_t wcl_mem) const
+{
+    // classification of the lines, by line address
+    std::vector<std::pair<Addr, LineAccessors>> lines(m_lines.begin(), m_lines.end());
+    std::sort(lines.begin(), lines.end(),
+              [](const std::pair<Addr, LineAccessors> &a, const std::pair<Addr, LineAccessors> &b) {
+                  return a.first < b.first;
+              });
+    std::ofstream lines_file(prefix + ".lines.csv");
+    fatal_if(!lines_file, "Unable to open %s.lines.csv\n", prefix);
+    lines_file << "#line address,BBs,shared BBs" << std::endl;
+    size_t num_shared_lines = 0;
+    for (const auto &line : lines) {
+        size_t num_private = 0;
+        size_t num_shared = 0;
+        for (uint32_t i = line.second.private_head; i != noAccessor; i = m_accessors[i].next) {
+            num_private++;
+        }
+        for (uint32_t i = line.second.shared_head; i != noAccessor; i = m_accessors[i].next) {
+            num_shared++;
+        }
+        if (num_shared > 0) {
+            num_shared_lines++;
+        }
+        lines_file << "0x" << std::hex << line.first << std::dec << ","
+                   << num_private + num_shared << "," << num_shared << "\n";
+    }
+    lines_file.close();
+
+    // accesses of the basic blocks by category and hit level
+    const size_t num_counters = NUM_ACCESS_CATEGORIES * numHitLevels;
+    std::vector<uint64_t> counters(m_bbs.size() * num_counters, 0);
+    for (const Accessor &a : m_accessors) {
+        AccessCategory category;
+        if (a.is_ifetch) {
+            category = a.is_shared ? SHARED_INST : PRIVATE_INST;
+        } else {
+            category = a.is_shared ? SHARED_DATA : PRIVATE_DATA;
+        }
+        for (int j = 0; j < numHitLevels; ++j) {
+            counters[a.bb_id * num_counters + category * numHitLevels + j] += a.counters[j];
+        }
+    }
+
+    // weights of the basic blocks, weights[bb_id * NUM_CONFIGS + config]
+    std::vector<uint64_t> weights(m_bbs.size() * NUM_CONFIGS, 0);
+    std::ofstream weights_file(prefix + ".weights.csv");
+    fatal_if(!weights_file, "Unable to open %s.weights.csv\n", prefix);
+    weights_file << "#BB,thread,exec cycles";
+    for (int c = 0; c < NUM_CONFIGS; ++c) {
+        weights_file << "," << configNames[c];
+    }
+    weights_file << std::endl;
+    for (int c = 0; c < NUM_CONFIGS; ++c) {
+        uint64_t coefficients[NUM_ACCESS_CATEGORIES][numHitLevels];
+        configCoefficients(static_cast<Config>(c), wcl_l1, wcl_llc, wcl_mem, coefficients);
+        for (size_t bb_id = 0; bb_id < m_bbs.size(); ++bb_id) {
+            uint64_t weight = m_bbs[bb_id].exec_cycles;
+            for (size_t j = 0; j < num_counters; ++j) {
+                weight += coefficients[j / numHitLevels][j % numHitLevels] *
+                          counters[bb_id * num_counters + j];
+            }
+            weights[bb_id * NUM_CONFIGS + c] = weight;
+        }
+    }
+    for (size_t bb_id = 0; bb_id < m_bbs.size(); ++bb_id) {
+        const BasicBlock &bb = m_bbs[bb_id];
+        if (bb.task == -1) {
+            continue;
+        }
+        weights_file << bb_id << "," << bb.thread_id << "," << bb.exec_cycles;
+        for (int c = 0; c < NUM_CONFIGS; ++c) {
+            weights_file << "," << weights[bb_id * NUM_CONFIGS + c];
+        }
+        weights_file << "\n";
+    }
+    weights_file.close();
+
+    // WCRTs (Graham's bound) as computed by the analyzer
+    std::vector<std::vector<int>> succ;
+    buildDAG(succ);
+    std::vector<int> num_preds(m_bbs.size(), 0);
+    for (const std::vector<int> &s : succ) {
+        for (int v : s) {
+            num_preds[v]++;
+        }
+    }
+    std::vector<int> topo_order;
+    topo_order.reserve(m_bbs.size());
+    for (size_t u = 0; u < m_bbs.size(); ++u) {
+        if (num_preds[u] == 0) {
+            topo_order.push_back(u);
+        }
+    }
+    for (size_t i = 0; i < topo_order.size(); ++i) {
+        for (int v : succ[topo_order[i]]) {
+            if (--num_preds[v] == 0) {
+                topo_order.push_back(v);
+            }
+        }
+    }
+    assert(topo_order.size() == m_bbs.size());
+    std::vector<uint64_t> longest_path(m_bbs.size() * NUM_CONFIGS, 0);
+    for (auto it = topo_order.rbegin(); it != topo_order.rend(); ++it) {
+        int u = *it;
+        for (int v : succ[u]) {
+            for (int c = 0; c < NUM_CONFIGS; ++c) {
+                longest_path[u * NUM_CONFIGS + c] = std::max(longest_path[u * NUM_CONFIGS + c],
+                    weights[u * NUM_CONFIGS + c] + longest_path[v * NUM_CONFIGS + c]);
+            }
+        }
+    }
+
+    std::ofstream wcrt_file(prefix + ".wcrt.csv");
+    fatal_if(!wcrt_file, "Unable to open %s.wcrt.csv\n", prefix);
+    wcrt_file << "#cores,WCL(L1),WCL(LLC),WCL(MEM),config,WCRT,critical path,volume" << std::endl;
+    for (int c = 0; c < NUM_CONFIGS; ++c) {
+        uint64_t critical_path = longest_path[c];
+        uint64_t volume = 0;
+        for (size_t bb_id = 0; bb_id < m_bbs.size(); ++bb_id) {
+            volume += weights[bb_id * NUM_CONFIGS + c];
+        }
+        double wcrt = critical_path + (double)(volume - critical_path) / num_cores;
+        wcrt_file << num_cores << "," << wcl_l1 << "," << wcl_llc << "," << wcl_mem << ","
+                  << configNames[c] << "," << (uint64_t)wcrt << ","
+                  << critical_path << "," << volume << std::endl;
+    }
+    wcrt_file.close();
+
+    inform("omptr online classification: %d basic blocks, %d lines, %d shared lines\n",
+           m_bbs.size(), lines.size(), num_shared_lines);
+}
+
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,158 @@
+/**
+ * @file
+ * Online shared/private classification of the lines accessed by the basic blocks of an omptr
+ * program, in place of the offline pass of the analyzer over the DAG and the mem stats file.
+ *
+ * The DAG is received as the tasks are created: FORK (a basic block creates a task) and
+ * JOIN (a basic block is followed by a taskwait) markers of the omptr runtime. Since a taskwait
+ * waits for all the children created since the previous one, the DAG is series-parallel and
+ * every basic block gets a happens-before tag: its task, its node in the task and its segment
+ * (number of taskwaits before it in the task). Two basic blocks are ordered iff their positions
+ * in the lowest common ancestor task of their tasks are, so a query only climbs the task tree.
+ * A task that ends without waiting for its children is not a strict fork/join: its children only
+ * reach the end of their own task, so a position lifted through it is ordered only after its creator.
+ *
+ * The stats of a basic block are added to the accessors of their lines when it ends, with the
+ * rule of the analyzer: an access of a line is shared if the line is also accessed by a parallel
+ * basic block, unless both are data accesses from the same thread. The accessors of a line are
+ * kept in two lists: the private ones, which a new accessor may still turn shared, and the shared
+ * ones, which are final and only searched (newest first) for a witness of the new accessor.
+ *
+ * At the end of the simulation, the classifier writes, next to the trace file:
+ * - <trace>.lines.csv: every line with the number of basic blocks accessing it and
+ *   the number of those whose accesses are shared,
+ * - <trace>.weights.csv: the execution cycles and the WCRT weight of every basic block
+ *   in each LLC management configuration,
+ * - <trace>.wcrt.csv: the WCRT of each configuration, in the format of the analyzer sweeps.
+ */
+
+#ifndef __MEM_RUBY_SYSTEM_CUSTOMMEMONLINECLASSIFIER_HH__
+#define __MEM_RUBY_SYSTEM_CUSTOMMEMONLINECLASSIFIER_HH__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+struct AddrAccessStats;
+
+class CustomMemOnlineClassifier
+{
+    public:
+        CustomMemOnlineClassifier();
+
+        /** bb_id creates a task starting with child_bb_id, its task continues with next_bb_id. */
+        void fork(int bb_id, int child_bb_id, int next_bb_id);
+
+        /** bb_id is followed by a taskwait, its task continues with next_bb_id. */
+        void join(int bb_id, int next_bb_id);
+
+        /** Add the stats of a line accessed by a basic block and classify them. */
+        void record(const AddrAccessStats &stats);
+
+        void recordExecCycles(int bb_id, int thread_id, uint64_t exec_cycles);
+
+        /** True if u reaches v in the DAG. */
+        bool reaches(int u, int v) const;
+
+        /** True if neither of u and v reaches the other. */
+        bool parallel(int u, int v) const;
+
+        /**
+         * Write the classification of the lines, the weights of the basic blocks and the WCRTs
+         * on num_cores cores, at <prefix>.lines.csv, <prefix>.weights.csv and <prefix>.wcrt.csv.
+         */
+        void write(const std::string &prefix, int num_cores,
+                   uint64_t wcl_l1, uint64_t wcl_llc, uint64_t wcl_mem) const;
+
+        /** WCLs measured on the platforms with 2, 4 and 8 cores (8 for any other number of cores). */
+        static void defaultWCLs(int num_cores, uint64_t &wcl_l1, uint64_t &wcl_llc, uint64_t &wcl_mem);
+
+    private:
+        enum HitLevel {
+            L1_HIT,
+            LLC_HIT,  // remote L1 or L2 hit
+            MEMORY_ACCESS,
+            NUM_HIT_LEVELS
+        };
+
+        struct BasicBlock {
+            int task;
+            int node;
+            int seg;
+            int thread_id;
+            uint64_t exec_cycles;
+        };
+
+        struct Task {
+            int parent;
+            // position of the basic block creating the task in the parent task
+            int creator_node;
+            int creator_seg;
+            int depth;
+            // basic blocks in node order
+            std::vector<int> bbs;
+            // first basic block of every segment
+            std::vector<int> seg_first_bb;
+            std::vector<int> children;
+        };
+
+        /** Position of a basic block, or of the creator of its ancestor task, in a task. */
+        struct Position {
+            int task;
+            int node;
+            int seg;
+            bool lifted;
+            // every task lifted through is waited for by its parent
+            bool joined;
+        };
+
+        /** A basic block accessing a line, in one of the lists of the accessors of the line. */
+        struct Accessor {
+            int bb_id;
+            int thread_id;
+            bool is_ifetch;
+            bool is_shared;
+            // next accessor in the list, noAccessor at the end of the list
+            uint32_t next;
+            uint64_t counters[NUM_HIT_LEVELS];
+        };
+
+        static const uint32_t noAccessor = UINT32_MAX;
+
+        /** Heads of the lists of the private and the shared accessors of a line. */
+        struct LineAccessors {
+            uint32_t private_head;
+            uint32_t shared_head;
+        };
+
+        std::vector<BasicBlock> m_bbs;
+        std::vector<Task> m_tasks;
+        std::unordered_map<Addr, LineAccessors> m_lines;
+        std::vector<Accessor> m_accessors;
+
+        BasicBlock &getBB(int bb_id);
+        void addBB(int bb_id, int task, int node, int seg);
+
+        /** Climb the task tree from u and v to the lowest common ancestor task of their tasks. */
+        void commonTask(int u, int v, Position &pu, Position &pv) const;
+
+        /** True if the basic block at pu reaches the one at pv, both in the same task. */
+        static bool reaches(const Position &pu, const Position &pv);
+
+        /** Edges of the DAG, as successor lists indexed by bb_id. */
+        void buildDAG(std::vector<std::vector<int>> &succ) const;
+};
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_SYSTEM_CUSTOMMEMONLINECLASSIFIER_HH__
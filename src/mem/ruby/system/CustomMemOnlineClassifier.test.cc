@@ -0,0 +1,181 @@
+/**
+ * @file
+ * Unit tests of the online classification of the CustomMemProbe.
+ * The DAG and the memory stats are those of omptr/analyzer/tests/unjoined_task, whose
+ * expected.lines.csv and expected.wcrt.csv are written by the offline analyzer
+ * (make test in omptr/analyzer checks that it still does).
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mem/ruby/system/CustomMemOnlineClassifier.hh"
+#include "mem/ruby/system/CustomMemProbe.hh"
+
+using namespace gem5;
+using namespace gem5::ruby;
+
+namespace
+{
+
+/** Stats of a line accessed by a basic block, exec_cycles of the basic block if line_address is 0. */
+struct BBStats
+{
+    int bb_id;
+    int thread_id;
+    Addr line_address;
+    bool is_ifetch;
+    uint64_t num_local_l1_hit;
+    uint64_t num_remote_l1_hit;
+    uint64_t num_l2_hit;
+    uint64_t num_memory_access;
+    uint64_t exec_cycles;
+};
+
+/**
+ * omptr/analyzer/tests/unjoined_task/mem_stats.csv, in the order the basic blocks end.
+ * Task 0 (BBs 0, 2, 3) creates task 1 (BBs 1, 5) in BB 0 and waits for it before BB 3.
+ * Task 1 creates task 2 (BB 4) in BB 1 and ends without waiting for it,
+ * so BB 4 is parallel to BB 2 and BB 3 of task 0.
+ */
+const std::vector<BBStats> unjoinedTaskStats = {
+    {0, 0, 0, false, 0, 0, 0, 0, 100},
+    {0, 0, 0x1000, true, 10, 0, 0, 1, 0},
+    {0, 0, 0x20c0, false, 0, 0, 0, 1, 0},
+    {1, 1, 0, false, 0, 0, 0, 0, 50},
+    {1, 1, 0x1080, true, 2, 0, 0, 1, 0},
+    {2, 0, 0, false, 0, 0, 0, 0, 70},
+    {2, 0, 0x2080, false, 5, 1, 0, 0, 0},
+    {5, 1, 0, false, 0, 0, 0, 0, 30},
+    {5, 1, 0x1080, true, 2, 0, 0, 0, 0},
+    {5, 1, 0x2040, false, 4, 0, 0, 1, 0},
+    {3, 0, 0, false, 0, 0, 0, 0, 40},
+    {3, 0, 0x1000, true, 8, 0, 1, 0, 0},
+    {3, 0, 0x1040, true, 3, 0, 0, 0, 0},
+    {3, 0, 0x2000, false, 1, 0, 1, 0, 0},
+    {3, 0, 0x2040, false, 2, 0, 0, 0, 0},
+    {4, 1, 0, false, 0, 0, 0, 0, 200},
+    {4, 1, 0x1040, true, 6, 0, 0, 1, 0},
+    {4, 1, 0x2000, false, 3, 0, 0, 2, 0},
+    {4, 1, 0x2080, false, 0, 0, 0, 1, 0},
+    {4, 1, 0x20c0, false, 1, 0, 0, 0, 0},
+};
+
+/** expected.lines.csv */
+const char *const unjoinedTaskLines =
+    "#line address,BBs,shared BBs\n"
+    "0x1000,2,0\n"
+    "0x1040,2,2\n"
+    "0x1080,2,0\n"
+    "0x2000,2,2\n"
+    "0x2040,2,0\n"
+    "0x2080,2,2\n"
+    "0x20c0,2,0\n";
+
+/** expected.wcrt.csv */
+const char *const unjoinedTaskWCRTs =
+    "#cores,WCL(L1),WCL(LLC),WCL(MEM),config,WCRT,critical path,volume\n"
+    "2,1,87,568,SHARE,23055,12676,33434\n"
+    "2,1,87,568,COLOR,10617,4724,16510\n"
+    "2,1,87,568,PAR,4293,2470,6116\n"
+    "2,1,87,568,COLOR_PRIVATE_INST,8065,4724,11407\n";
+
+/** Build the DAG of the unjoined task test, with the markers of the omptr runtime. */
+void
+buildUnjoinedTaskDAG(CustomMemOnlineClassifier &classifier)
+{
+    classifier.fork(0, 1, 2);
+    classifier.fork(1, 4, 5);
+    classifier.join(2, 3);
+}
+
+void
+recordStats(CustomMemOnlineClassifier &classifier, const BBStats &s)
+{
+    if (s.line_address == 0) {
+        classifier.recordExecCycles(s.bb_id, s.thread_id, s.exec_cycles);
+        return;
+    }
+    AddrAccessStats stats = {};
+    stats.bb_id = s.bb_id;
+    stats.thread_id = s.thread_id;
+    stats.address = s.line_address;
+    stats.line_address = s.line_address;
+    stats.is_ifetch = s.is_ifetch;
+    stats.num_local_l1_hit = s.num_local_l1_hit;
+    stats.num_remote_l1_hit = s.num_remote_l1_hit;
+    stats.num_l2_hit = s.num_l2_hit;
+    stats.num_memory_access = s.num_memory_access;
+    stats.is_metadata = false;
+    classifier.record(stats);
+}
+
+std::string
+readFile(const std::string &filename)
+{
+    std::ifstream file(filename);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+} // anonymous namespace
+
+TEST(CustomMemOnlineClassifierTest, UnjoinedTaskReachability)
+{
+    CustomMemOnlineClassifier classifier;
+    buildUnjoinedTaskDAG(classifier);
+
+    // BB 4 reaches nothing, as task 1 does not wait for task 2
+    for (int v : {0, 1, 2, 3, 5}) {
+        EXPECT_FALSE(classifier.reaches(4, v)) << "BB " << v;
+    }
+    EXPECT_TRUE(classifier.parallel(4, 2));
+    EXPECT_TRUE(classifier.parallel(4, 3));
+    EXPECT_TRUE(classifier.parallel(4, 5));
+    EXPECT_TRUE(classifier.reaches(0, 4));
+    EXPECT_TRUE(classifier.reaches(1, 4));
+
+    // task 1 itself is waited for by BB 3
+    EXPECT_TRUE(classifier.reaches(5, 3));
+    EXPECT_TRUE(classifier.reaches(1, 3));
+    EXPECT_TRUE(classifier.parallel(1, 2));
+    EXPECT_TRUE(classifier.parallel(5, 2));
+}
+
+TEST(CustomMemOnlineClassifierTest, UnjoinedTaskMatchesAnalyzer)
+{
+    // BB 4 of the unjoined task ends after BB 3, then before it
+    std::vector<BBStats> bb4_last = unjoinedTaskStats;
+    std::vector<BBStats> bb4_first;
+    for (const BBStats &s : unjoinedTaskStats) {
+        if (s.bb_id == 4) {
+            bb4_first.push_back(s);
+        }
+    }
+    for (const BBStats &s : unjoinedTaskStats) {
+        if (s.bb_id != 4) {
+            bb4_first.push_back(s);
+        }
+    }
+
+    for (const std::vector<BBStats> *order : {&bb4_last, &bb4_first}) {
+        CustomMemOnlineClassifier classifier;
+        buildUnjoinedTaskDAG(classifier);
+        for (const BBStats &s : *order) {
+            recordStats(classifier, s);
+        }
+
+        const std::string prefix = testing::TempDir() + "unjoined_task";
+        uint64_t wcl_l1, wcl_llc, wcl_mem;
+        CustomMemOnlineClassifier::defaultWCLs(2, wcl_l1, wcl_llc, wcl_mem);
+        classifier.write(prefix, 2, wcl_l1, wcl_llc, wcl_mem);
+
+        EXPECT_EQ(readFile(prefix + ".lines.csv"), unjoinedTaskLines);
+        EXPECT_EQ(readFile(prefix + ".wcrt.csv"), unjoinedTaskWCRTs);
+    }
+}
@@ -6,6 +6,9 @@
 #include "sim/core.hh"
 #include "cpu/simple/exec_context.hh"
 #include "debug/OMPTR.hh"
+#include "mem/ruby/system/CustomMemColumnarTrace.hh"
+#include "mem/ruby/system/CustomMemOnlineClassifier.hh"
+#include "mem/ruby/system/RubySystem.hh"
 #include "proto/custom_mem_trace.pb.h"
 
 
@@ -22,6 +25,52 @@ std::map<int,uint64_t> CustomMemProbe::m_cpus_simulated_cycles;
 std::vector<BaseSimpleCPU*> CustomMemProbe::m_cpus; 
 CustomMemProbe* CustomMemProbe::m_instance;
 
+void
+AddrStatsTable::reset(size_t capacity)
+{
+    slots.assign(capacity, AddrAccessStats());
+    for (AddrAccessStats& slot : slots) {
+        slot.bb_id = -1;
+    }
+    numEntries = 0;
+}
+
+void
+AddrStatsTable::rehash(size_t capacity)
+{
+    std::vector<AddrAccessStats> old_slots = std::move(slots);
+    reset(capacity);
+    for (const AddrAccessStats& old_slot : old_slots) {
+        if (old_slot.bb_id != -1) {
+            bool is_new;
+            findOrInsert(old_slot.bb_id, old_slot.line_address, is_new) = old_slot;
+        }
+    }
+}
+
+AddrAccessStats&
+AddrStatsTable::findOrInsert(int bb_id, Addr line_address, bool& is_new)
+{
+    assert(bb_id != -1);
+    // keep the load factor at most 1/2
+    if ((numEntries + 1) * 2 > slots.size()) {
+        rehash(slots.size() * 2);
+    }
+    size_t i = slotIndex(bb_id, line_address);
+    while (slots[i].bb_id != -1) {
+        if (slots[i].bb_id == bb_id && slots[i].line_address == line_address) {
+            is_new = false;
+            return slots[i];
+        }
+        i = (i + 1) & (slots.size() - 1);
+    }
+    numEntries++;
+    is_new = true;
+    slots[i].bb_id = bb_id;
+    slots[i].line_address = line_address;
+    return slots[i];
+}
+
 void
 CustomMemProbe::check()
 {
@@ -72,6 +121,30 @@ CustomMemProbe::end_bb_scope(int thread_id) {
     uint64_t scopedSimulatedCycles = simulated_cycles - m_cpus_simulated_cycles[thread_id];
     uint64_t exec_cycles = scopedNotIdleFraction * scopedSimulatedCycles;
     m_instance->recordExecCycles(bb_id, thread_id, exec_cycles);
+
+    // the basic block is done, no more accesses are recorded for it
+    if (!m_instance->m_enable_raw_trace) {
+        m_instance->writeAddrStats(m_instance->getAddrStats(thread_id));
+    }
+}
+
+void
+CustomMemProbe::fork_task(int bb_id, int child_bb_id, int next_bb_id)
+{
+    DPRINTFR(OMPTR, "BB %d creates a task starting with BB %d, continues with BB %d\n",
+             bb_id, child_bb_id, next_bb_id);
+    if (m_instance != nullptr && m_instance->m_online != nullptr) {
+        m_instance->m_online->fork(bb_id, child_bb_id, next_bb_id);
+    }
+}
+
+void
+CustomMemProbe::join_tasks(int bb_id, int next_bb_id)
+{
+    DPRINTFR(OMPTR, "BB %d waits for its tasks, continues with BB %d\n", bb_id, next_bb_id);
+    if (m_instance != nullptr && m_instance->m_online != nullptr) {
+        m_instance->m_online->join(bb_id, next_bb_id);
+    }
 }
 
 CustomMemTrace_DataRegion
@@ -99,8 +172,13 @@ CustomMemProbe::CustomMemProbe(const Params &p)
     : ProbeListenerObject(p),
       m_enable_raw_trace(p.enable_raw_trace),
       m_use_traffic_gen(p.use_traffic_gen),
+      m_trace_compress(p.trace_compress),
       m_trace_stream(nullptr),
-      m_addr_stats()
+      m_columnar_stream(nullptr),
+      m_online(nullptr),
+      m_wcl_l1(p.wcl_l1),
+      m_wcl_llc(p.wcl_llc),
+      m_wcl_mem(p.wcl_mem)
 {
     // create proto output stream to dump traces
     if (p.trace_file != "") {
@@ -118,14 +196,73 @@ CustomMemProbe::CustomMemProbe(const Params &p)
         m_cpus = p.cpus;
     }
 
-    m_trace_file = m_trace_file + (m_enable_raw_trace ? ".trc" : ".stats");
-    m_trace_file = m_trace_file + (p.trace_compress ? ".gz" : "");
-    m_trace_stream = new ProtoOutputStream(m_trace_file);
+    if (p.online_classification) {
+        fatal_if(m_enable_raw_trace, "The online classification replaces the per basic block stats, "
+                 "it cannot be used with the raw trace\n");
+        fatal_if(m_use_traffic_gen, "The online classification needs the omptr DAG, "
+                 "it cannot be used with the traffic generator\n");
+        // the outputs are named after the trace file, and no stats are written
+        m_online = new CustomMemOnlineClassifier();
+    } else if (m_enable_raw_trace && p.columnar_trace) {
+        // the columnar trace compresses its blocks itself, it is opened once the line size is known
+        m_trace_file = m_trace_file + ".ctrc";
+    } else {
+        m_trace_file = m_trace_file + (m_enable_raw_trace ? ".trc" : ".stats");
+        m_trace_file = m_trace_file + (p.trace_compress ? ".gz" : "");
+        m_trace_stream = new ProtoOutputStream(m_trace_file);
+    }
 
     // register simulation exit callback to safely close proto output stream
     registerExitCallback([this]() { closeStreams(); });
 }
 
+void
+CustomMemProbe::init()
+{
+    ProbeListenerObject::init();
+    if (m_enable_raw_trace && m_trace_stream == nullptr) {
+        m_columnar_stream = new CustomMemColumnarTraceWriter(
+            m_trace_file, RubySystem::getBlockSizeBits(), m_trace_compress);
+    }
+}
+
+AddrStatsTable&
+CustomMemProbe::getAddrStats(int thread_id)
+{
+    assert(thread_id >= 0);
+    if (thread_id >= m_addr_stats.size()) {
+        m_addr_stats.resize(thread_id + 1);
+    }
+    return m_addr_stats[thread_id];
+}
+
+void
+CustomMemProbe::writeAddrStats(AddrStatsTable& addr_stats)
+{
+    if (m_online != nullptr) {
+        addr_stats.flush([this](const AddrAccessStats& stats) {
+            m_online->record(stats);
+        });
+        return;
+    }
+    addr_stats.flush([this](const AddrAccessStats& stats) {
+        ProtoMessage::AddrAccessStats msg;
+        msg.set_bb_id(stats.bb_id);
+        msg.set_address(stats.address);
+        msg.set_line_address(stats.line_address);
+        msg.set_is_ifetch(stats.is_ifetch);
+        msg.set_num_local_l1_hit(stats.num_local_l1_hit);
+        msg.set_num_remote_l1_hit(stats.num_remote_l1_hit);
+        msg.set_num_l2_hit(stats.num_l2_hit);
+        msg.set_num_memory_access(stats.num_memory_access);
+        msg.set_thread_id(stats.thread_id);
+        msg.set_data_region(static_cast<ProtoMessage::AddrAccessStats_DataRegion>(stats.data_region));
+        msg.set_is_metadata(stats.is_metadata);
+        msg.set_exec_cycles(stats.exec_cycles);
+        m_trace_stream->write(msg);
+    });
+}
+
 void
 CustomMemProbe::regProbeListeners()
 {
@@ -153,7 +290,9 @@ CustomMemProbe::recordMemTrace(const CustomMemTrace &mem_trace)
         }
     }
     
-    if (m_enable_raw_trace) {
+    if (m_columnar_stream != nullptr) {
+        m_columnar_stream->write(mem_trace, bb_id);
+    } else if (m_enable_raw_trace) {
         ProtoMessage::CustomMemTrace mem_trace_msg;
         mem_trace_msg.set_bb_id(bb_id);
         mem_trace_msg.set_address(mem_trace.address);
@@ -164,91 +303,83 @@ CustomMemProbe::recordMemTrace(const CustomMemTrace &mem_trace)
         mem_trace_msg.set_data_region(static_cast<ProtoMessage::CustomMemTrace_DataRegion>(mem_trace.data_region));
         m_trace_stream->write(mem_trace_msg);
     } else if (bb_id != -1) {
-        AddrAccessKey key;
-        key.bb_id = bb_id;
-        key.address = mem_trace.line_address;  // record statistics per line address
-
-        auto entry = m_addr_stats.find(key);
-        if (entry != m_addr_stats.end()) {
-            // update access counter if entry exists
-            entry->second.record(mem_trace.hit_status);
-        } else {
+        // record statistics per line address
+        bool is_new;
+        AddrAccessStats& entry = getAddrStats(thread_id).findOrInsert(
+            bb_id, mem_trace.line_address, is_new);
+        if (is_new) {
             // create new addr stats entry
-            AddrAccessStats new_entry;
-            new_entry.bb_id = bb_id;
-            new_entry.thread_id = thread_id;
-            new_entry.address = mem_trace.line_address;  // use line address instead
-            new_entry.line_address = mem_trace.line_address;
-            new_entry.data_region = mem_trace.data_region;
-            new_entry.is_ifetch = (mem_trace.access_type == CustomMemTrace_AccessType::IFETCH);
-            new_entry.num_local_l1_hit = 0;
-            new_entry.num_remote_l1_hit = 0;
-            new_entry.num_l2_hit = 0;
-            new_entry.num_memory_access = 0;
-            new_entry.is_metadata = false;
-            new_entry.exec_cycles = 0;
-            // update access counter
-            new_entry.record(mem_trace.hit_status);
-            // insert to map
-            m_addr_stats.emplace(key, new_entry);
+            entry.thread_id = thread_id;
+            entry.address = mem_trace.line_address;  // use line address instead
+            entry.data_region = mem_trace.data_region;
+            entry.is_ifetch = (mem_trace.access_type == CustomMemTrace_AccessType::IFETCH);
+            entry.num_local_l1_hit = 0;
+            entry.num_remote_l1_hit = 0;
+            entry.num_l2_hit = 0;
+            entry.num_memory_access = 0;
+            entry.is_metadata = false;
+            entry.exec_cycles = 0;
         }
+        // update access counter
+        entry.record(mem_trace.hit_status);
     }
 }
 
 void
 CustomMemProbe::recordExecCycles(int bb_id, int thread_id, uint64_t exec_cycles) {
-    AddrAccessKey key;
-    key.bb_id = bb_id;
-    key.address = 0;
-
-    auto entry = m_addr_stats.find(key);
-    if (entry != m_addr_stats.end()) {
-        // update access counter if entry exists
-        entry->second.is_metadata = true;
-        entry->second.exec_cycles = exec_cycles;
-    } else {
+    if (m_enable_raw_trace) {
+        // only the columnar raw trace keeps the execution cycles
+        if (m_columnar_stream != nullptr) {
+            m_columnar_stream->writeExecCycles(bb_id, thread_id, exec_cycles);
+        }
+        return;
+    }
+    if (m_online != nullptr) {
+        m_online->recordExecCycles(bb_id, thread_id, exec_cycles);
+        return;
+    }
+
+    bool is_new;
+    AddrAccessStats& entry = getAddrStats(thread_id).findOrInsert(bb_id, 0, is_new);
+    if (is_new) {
         // create new addr stats entry
-        AddrAccessStats new_entry;
-        new_entry.bb_id = bb_id;
-        new_entry.thread_id = thread_id;
-        new_entry.address = 0;
-        new_entry.line_address = 0;
-        new_entry.data_region = CustomMemTrace_DataRegion::GLOBAL;
-        new_entry.is_ifetch = false;
-        new_entry.num_local_l1_hit = 0;
-        new_entry.num_remote_l1_hit = 0;
-        new_entry.num_l2_hit = 0;
-        new_entry.num_memory_access = 0;
-        new_entry.is_metadata = true;
-        new_entry.exec_cycles = exec_cycles;
-        // insert to map
-        m_addr_stats.emplace(key, new_entry);
+        entry.thread_id = thread_id;
+        entry.address = 0;
+        entry.data_region = CustomMemTrace_DataRegion::GLOBAL;
+        entry.is_ifetch = false;
+        entry.num_local_l1_hit = 0;
+        entry.num_remote_l1_hit = 0;
+        entry.num_l2_hit = 0;
+        entry.num_memory_access = 0;
     }
+    entry.is_metadata = true;
+    entry.exec_cycles = exec_cycles;
 }
 
 void 
 CustomMemProbe::closeStreams()
 {
     if (m_enable_raw_trace == false) {
-        for (const auto& entry : m_addr_stats) {
-            ProtoMessage::AddrAccessStats msg;
-            msg.set_bb_id(entry.second.bb_id);
-            msg.set_address(entry.second.address);
-            msg.set_line_address(entry.second.line_address);
-            msg.set_is_ifetch(entry.second.is_ifetch);
-            msg.set_num_local_l1_hit(entry.second.num_local_l1_hit);
-            msg.set_num_remote_l1_hit(entry.second.num_remote_l1_hit);
-            msg.set_num_l2_hit(entry.second.num_l2_hit);
-            msg.set_num_memory_access(entry.second.num_memory_access);
-            msg.set_thread_id(entry.second.thread_id);
-            msg.set_data_region(static_cast<ProtoMessage::AddrAccessStats_DataRegion>(entry.second.data_region));
-            msg.set_is_metadata(entry.second.is_metadata);
-            msg.set_exec_cycles(entry.second.exec_cycles);
-            m_trace_stream->write(msg);
+        // basic blocks that did not end, e.g. with the traffic generator
+        for (AddrStatsTable& addr_stats : m_addr_stats) {
+            writeAddrStats(addr_stats);
         }
     }
+    if (m_online != nullptr) {
+        int num_cores = m_cpus.size();
+        uint64_t wcl_l1, wcl_llc, wcl_mem;
+        CustomMemOnlineClassifier::defaultWCLs(num_cores, wcl_l1, wcl_llc, wcl_mem);
+        m_online->write(m_trace_file, num_cores,
+                        m_wcl_l1 != 0 ? m_wcl_l1 : wcl_l1,
+                        m_wcl_llc != 0 ? m_wcl_llc : wcl_llc,
+                        m_wcl_mem != 0 ? m_wcl_mem : wcl_mem);
+        delete m_online;
+        m_online = nullptr;
+    }
     if (m_trace_stream != NULL)
         delete m_trace_stream;
+    if (m_columnar_stream != nullptr)
+        delete m_columnar_stream;
 }
 
 }
@@ -19,6 +19,9 @@ class Process;
 namespace ruby
 {
 
+class CustomMemColumnarTraceWriter;
+class CustomMemOnlineClassifier;
+
 enum CustomMemTrace_AccessType {
     IFETCH,
     READ,
@@ -80,27 +83,60 @@ typedef struct AddrAccessStats {
     }
 } AddrAccessStats;
 
-typedef struct AddrAccessKey {
-    int bb_id;
-    Addr address;
+// Open-addressing (linear probing) hash table of the access stats of a thread, keyed on
+// (bb_id, line address). Empty slots have bb_id -1.
+class AddrStatsTable
+{
+    public:
+        AddrStatsTable() { reset(initialCapacity); }
+
+        // return the stats of the line in the basic block, is_new is set if they were just created
+        AddrAccessStats& findOrInsert(int bb_id, Addr line_address, bool& is_new);
+
+        bool empty() const { return numEntries == 0; }
+
+        // call f on every entry, then remove all the entries
+        template <class F>
+        void
+        flush(F f)
+        {
+            if (numEntries == 0) {
+                return;
+            }
+            for (const AddrAccessStats& slot : slots) {
+                if (slot.bb_id != -1) {
+                    f(slot);
+                }
+            }
+            // give back the memory of a large basic block
+            reset(numEntries * 8 < slots.size() ? initialCapacity : slots.size());
+        }
 
-    // Overload the less-than operator
-    bool operator<(const AddrAccessKey& other) const {
-        if (bb_id < other.bb_id) {
-            return true;
-        } else if (bb_id > other.bb_id) {
-            return false;
+    private:
+        static const size_t initialCapacity = 64;
+
+        std::vector<AddrAccessStats> slots;
+        size_t numEntries;
+
+        size_t
+        slotIndex(int bb_id, Addr line_address) const
+        {
+            uint64_t key = line_address ^ ((uint64_t)bb_id << 48);
+            return (key * 0x9E3779B97F4A7C15ULL >> 32) & (slots.size() - 1);
         }
-        // If bb_id is equal, compare address
-        return address < other.address;
-    }
-} AddrAccessKey;
+
+        // remove all the entries
+        void reset(size_t capacity);
+
+        void rehash(size_t capacity);
+};
 
 class CustomMemProbe : public ProbeListenerObject
 {
     public:
         typedef CustomMemProbeParams Params;
         CustomMemProbe(const Params &p); 
+        void init() override;
         void regProbeListeners() override;  // Register probe listeners
 
         static std::map<int,int> m_bb_id_map;
@@ -110,6 +146,9 @@ class CustomMemProbe : public ProbeListenerObject
         static CustomMemProbe* m_instance;
         static void start_bb_scope(int bb_id, int thread_id);
         static void end_bb_scope(int thread_id);
+        // DAG edges of the omptr runtime, for the online classification
+        static void fork_task(int bb_id, int child_bb_id, int next_bb_id);
+        static void join_tasks(int bb_id, int next_bb_id);
 
         void recordMemTrace(const CustomMemTrace &mem_trace);
         void recordExecCycles(int bb_id, int thread_id, uint64_t exec_cycles);
@@ -120,8 +159,22 @@ class CustomMemProbe : public ProbeListenerObject
         std::string m_trace_file;
         bool m_enable_raw_trace;
         bool m_use_traffic_gen;
+        bool m_trace_compress;
         ProtoOutputStream *m_trace_stream;
-        std::map<AddrAccessKey, AddrAccessStats> m_addr_stats;
+        // raw trace stream in the columnar format, replaces m_trace_stream if columnar_trace is set
+        CustomMemColumnarTraceWriter *m_columnar_stream;
+        // classifies the lines and writes the basic block weights at exit instead of the stats,
+        // if online_classification is set
+        CustomMemOnlineClassifier *m_online;
+        uint64_t m_wcl_l1;
+        uint64_t m_wcl_llc;
+        uint64_t m_wcl_mem;
+        // access stats of the live basic blocks per thread,
+        // written to the trace stream when the basic block ends
+        std::vector<AddrStatsTable> m_addr_stats;
+
+        AddrStatsTable& getAddrStats(int thread_id);
+        void writeAddrStats(AddrStatsTable& addr_stats);
 
         static void check();
         void closeStreams();
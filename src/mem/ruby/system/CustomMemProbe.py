@@ -10,5 +10,17 @@ class CustomMemProbe(ProbeListenerObject):
     trace_file = Param.String("mem", "Memory trace output file")
     trace_compress = Param.Bool(True, "Enable compression")
     enable_raw_trace = Param.Bool(False, "Enable raw memory trace recording")
+    columnar_trace = Param.Bool(False, "Write the raw memory trace in the columnar binary format "
+                                       "instead of one protobuf message per access")
+    online_classification = Param.Bool(False, "Classify the shared lines and compute the WCRT "
+                                              "weights of the basic blocks during the simulation "
+                                              "instead of writing the per basic block stats "
+                                              "(the program must be built with -DOMPTR_ONLINE)")
+    wcl_l1 = Param.Unsigned(0, "WCL of an L1 hit for the online WCRT weights, "
+                               "0 for the default of the number of cpus")
+    wcl_llc = Param.Unsigned(0, "WCL of an LLC hit for the online WCRT weights, "
+                                "0 for the default of the number of cpus")
+    wcl_mem = Param.Unsigned(0, "WCL of a memory access for the online WCRT weights, "
+                                "0 for the default of the number of cpus")
     use_traffic_gen = Param.Bool(False, "If traffic generator is in use")
     cpus = VectorParam.BaseSimpleCPU([], "List of cpus in the system")
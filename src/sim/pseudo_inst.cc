@@ -59,6 +59,8 @@
 #include "debug/Quiesce.hh"
 #include "debug/WorkItems.hh"
 #include "dev/net/dist_iface.hh"
+#include "mem/cache/replacement_policies/par_rp.hh"
+#include "mem/ruby/system/CustomMemProbe.hh"
 #include "mem/se_translating_port_proxy.hh"
 #include "mem/translating_port_proxy.hh"
 #include "params/BaseCPU.hh"
@@ -595,5 +597,44 @@ workend(ThreadContext *tc, uint64_t workid, uint64_t threadid)
     }
 }
 
+void
+parMoveWays(ThreadContext *tc, uint64_t src_par_id, uint64_t dst_par_id,
+            uint64_t num_ways)
+{
+    DPRINTF(PseudoInst, "pseudo_inst::parMoveWays(%i, %i, %i)\n",
+            src_par_id, dst_par_id, num_ways);
+    replacement_policy::Par::moveWaysAll(src_par_id, dst_par_id, num_ways);
+}
+
+void
+omptrBBStart(ThreadContext *tc, uint64_t bb_id)
+{
+    DPRINTF(PseudoInst, "pseudo_inst::omptrBBStart(%i)\n", bb_id);
+    ruby::CustomMemProbe::start_bb_scope(bb_id, tc->contextId());
+}
+
+void
+omptrBBEnd(ThreadContext *tc)
+{
+    DPRINTF(PseudoInst, "pseudo_inst::omptrBBEnd()\n");
+    ruby::CustomMemProbe::end_bb_scope(tc->contextId());
+}
+
+void
+omptrFork(ThreadContext *tc, uint64_t bb_id, uint64_t child_bb_id,
+          uint64_t next_bb_id)
+{
+    DPRINTF(PseudoInst, "pseudo_inst::omptrFork(%i, %i, %i)\n", bb_id,
+            child_bb_id, next_bb_id);
+    ruby::CustomMemProbe::fork_task(bb_id, child_bb_id, next_bb_id);
+}
+
+void
+omptrJoin(ThreadContext *tc, uint64_t bb_id, uint64_t next_bb_id)
+{
+    DPRINTF(PseudoInst, "pseudo_inst::omptrJoin(%i, %i)\n", bb_id, next_bb_id);
+    ruby::CustomMemProbe::join_tasks(bb_id, next_bb_id);
+}
+
 } // namespace pseudo_inst
 } // namespace gem5
@@ -92,6 +92,13 @@ void debugbreak(ThreadContext *tc);
 void switchcpu(ThreadContext *tc);
 void workbegin(ThreadContext *tc, uint64_t workid, uint64_t threadid);
 void workend(ThreadContext *tc, uint64_t workid, uint64_t threadid);
+void parMoveWays(ThreadContext *tc, uint64_t src_par_id, uint64_t dst_par_id,
+                 uint64_t num_ways);
+void omptrBBStart(ThreadContext *tc, uint64_t bb_id);
+void omptrBBEnd(ThreadContext *tc);
+void omptrFork(ThreadContext *tc, uint64_t bb_id, uint64_t child_bb_id,
+               uint64_t next_bb_id);
+void omptrJoin(ThreadContext *tc, uint64_t bb_id, uint64_t next_bb_id);
 void m5Syscall(ThreadContext *tc);
 void togglesync(ThreadContext *tc);
 void triggerWorkloadEvent(ThreadContext *tc);
@@ -214,6 +221,26 @@ pseudoInstWork(ThreadContext *tc, uint8_t func, uint64_t &result)
         invokeSimcall<ABI>(tc, workend);
         return true;
 
+      case M5OP_PAR_MOVE_WAYS:
+        invokeSimcall<ABI>(tc, parMoveWays);
+        return true;
+
+      case M5OP_OMPTR_BB_START:
+        invokeSimcall<ABI>(tc, omptrBBStart);
+        return true;
+
+      case M5OP_OMPTR_BB_END:
+        invokeSimcall<ABI>(tc, omptrBBEnd);
+        return true;
+
+      case M5OP_OMPTR_FORK:
+        invokeSimcall<ABI>(tc, omptrFork);
+        return true;
+
+      case M5OP_OMPTR_JOIN:
+        invokeSimcall<ABI>(tc, omptrJoin);
+        return true;
+
       case M5OP_RESERVED1:
       case M5OP_RESERVED2:
       case M5OP_RESERVED3:
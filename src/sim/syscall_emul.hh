@@ -111,6 +111,7 @@
 #include "sim/syscall_return.hh"
 
 // @omptr tracing support
+#include "mem/cache/replacement_policies/par_rp.hh"
 #include "mem/ruby/system/CustomMemProbe.hh"
 
 #if defined(__APPLE__) && defined(__MACH__) && !defined(CMSG_ALIGN)
@@ -2684,9 +2685,11 @@ writeFunc(SyscallDesc *desc, ThreadContext *tc,
     if (bytes_written != -1)
         fsync(sim_fd);
 
-    // @omptr trace basic block scope
+    // @omptr trace basic block scope, DAG edges and partition resize
     if (bytes_written != -1) {
         int bb_id = -1;
+        int src_par_id, dst_par_id, num_ways;
+        int child_bb_id, next_bb_id;
         char bb_point[10];
         char *string_buffer = new char[nbytes + 1];
         std::memcpy(string_buffer, buf_arg.bufferPtr(), nbytes);
@@ -2697,6 +2700,15 @@ writeFunc(SyscallDesc *desc, ThreadContext *tc,
             } else if (strcmp(bb_point, "ends.") == 0) {
                 ruby::CustomMemProbe::end_bb_scope(tc->contextId());
             }
+        } else if (sscanf(string_buffer, "[OMPTR] PAR %d %d %d",
+                          &src_par_id, &dst_par_id, &num_ways) == 3) {
+            replacement_policy::Par::moveWaysAll(src_par_id, dst_par_id, num_ways);
+        } else if (sscanf(string_buffer, "[OMPTR] FORK %d %d %d",
+                          &bb_id, &child_bb_id, &next_bb_id) == 3) {
+            ruby::CustomMemProbe::fork_task(bb_id, child_bb_id, next_bb_id);
+        } else if (sscanf(string_buffer, "[OMPTR] JOIN %d %d",
+                          &bb_id, &next_bb_id) == 2) {
+            ruby::CustomMemProbe::join_tasks(bb_id, next_bb_id);
         }
         delete[] string_buffer;
     }
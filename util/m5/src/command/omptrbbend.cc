@@ -0,0 +1,19 @@
+#include "args.hh"
+#include "command.hh"
+#include "dispatch_table.hh"
+
+namespace
+{
+
+bool
+do_omptr_bb_end(const DispatchTable &dt, Args &args)
+{
+    (*dt.m5_omptr_bb_end)();
+    return true;
+}
+
+Command omptrbbend = {
+    "omptrbbend", 0, 0, do_omptr_bb_end, "\n"
+        "        End the omptr basic block of this thread" };
+
+} // anonymous namespace
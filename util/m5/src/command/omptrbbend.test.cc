@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "args.hh"
+#include "command.hh"
+#include "dispatch_table.hh"
+
+bool test_called;
+
+void
+test_m5_omptr_bb_end()
+{
+    test_called = true;
+}
+
+DispatchTable dt = { .m5_omptr_bb_end = &test_m5_omptr_bb_end };
+
+bool
+run(std::initializer_list<std::string> arg_args)
+{
+    Args args(arg_args);
+    return Command::run(dt, args);
+}
+
+TEST(OmptrBBEnd, Arguments)
+{
+    // Called with no arguments.
+    test_called = false;
+    EXPECT_TRUE(run({"omptrbbend"}));
+    EXPECT_TRUE(test_called);
+
+    // Called with one argument.
+    test_called = false;
+    EXPECT_FALSE(run({"omptrbbend", "1"}));
+    EXPECT_FALSE(test_called);
+}
@@ -0,0 +1,23 @@
+#include "args.hh"
+#include "command.hh"
+#include "dispatch_table.hh"
+
+namespace
+{
+
+bool
+do_omptr_bb_start(const DispatchTable &dt, Args &args)
+{
+    uint64_t bb_id;
+    if (!args.pop(bb_id))
+        return false;
+
+    (*dt.m5_omptr_bb_start)(bb_id);
+    return true;
+}
+
+Command omptrbbstart = {
+    "omptrbbstart", 1, 1, do_omptr_bb_start, "<bb_id>\n"
+        "        Start omptr basic block bb_id on this thread" };
+
+} // anonymous namespace
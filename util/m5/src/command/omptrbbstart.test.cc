@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "args.hh"
+#include "command.hh"
+#include "dispatch_table.hh"
+
+uint64_t test_bb_id;
+
+void
+test_m5_omptr_bb_start(uint64_t bb_id)
+{
+    test_bb_id = bb_id;
+}
+
+DispatchTable dt = { .m5_omptr_bb_start = &test_m5_omptr_bb_start };
+
+bool
+run(std::initializer_list<std::string> arg_args)
+{
+    Args args(arg_args);
+    return Command::run(dt, args);
+}
+
+TEST(OmptrBBStart, Arguments)
+{
+    // Called with no arguments.
+    EXPECT_FALSE(run({"omptrbbstart"}));
+
+    // Called with one argument.
+    test_bb_id = 50;
+    EXPECT_TRUE(run({"omptrbbstart", "12"}));
+    EXPECT_EQ(test_bb_id, 12);
+
+    // Called with two arguments.
+    EXPECT_FALSE(run({"omptrbbstart", "12", "13"}));
+
+    // Called with an invalid argument.
+    EXPECT_FALSE(run({"omptrbbstart", "foo"}));
+}
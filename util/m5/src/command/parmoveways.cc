@@ -0,0 +1,25 @@
+#include "args.hh"
+#include "command.hh"
+#include "dispatch_table.hh"
+
+namespace
+{
+
+bool
+do_par_move_ways(const DispatchTable &dt, Args &args)
+{
+    uint64_t src_par_id, dst_par_id, num_ways;
+    if (!args.pop(src_par_id) || !args.pop(dst_par_id) ||
+            !args.pop(num_ways, 1))
+        return false;
+
+    (*dt.m5_par_move_ways)(src_par_id, dst_par_id, num_ways);
+    return true;
+}
+
+Command parmoveways = {
+    "parmoveways", 2, 3, do_par_move_ways, "<src> <dst> [ways]\n"
+        "        Move ways (default 1) from LLC partition src to partition "
+            "dst" };
+
+} // anonymous namespace
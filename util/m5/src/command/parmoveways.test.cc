@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "args.hh"
+#include "command.hh"
+#include "dispatch_table.hh"
+
+uint64_t test_src_par_id;
+uint64_t test_dst_par_id;
+uint64_t test_num_ways;
+
+void
+test_m5_par_move_ways(uint64_t src_par_id, uint64_t dst_par_id,
+                      uint64_t num_ways)
+{
+    test_src_par_id = src_par_id;
+    test_dst_par_id = dst_par_id;
+    test_num_ways = num_ways;
+}
+
+DispatchTable dt = { .m5_par_move_ways = &test_m5_par_move_ways };
+
+bool
+run(std::initializer_list<std::string> arg_args)
+{
+    Args args(arg_args);
+    return Command::run(dt, args);
+}
+
+TEST(ParMoveWays, Arguments)
+{
+    // Called with no arguments.
+    EXPECT_FALSE(run({"parmoveways"}));
+
+    // Called with one argument.
+    EXPECT_FALSE(run({"parmoveways", "1"}));
+
+    // Called with two arguments.
+    test_src_par_id = 50;
+    test_dst_par_id = 40;
+    test_num_ways = 30;
+    EXPECT_TRUE(run({"parmoveways", "1", "2"}));
+    EXPECT_EQ(test_src_par_id, 1);
+    EXPECT_EQ(test_dst_par_id, 2);
+    EXPECT_EQ(test_num_ways, 1);
+
+    // Called with three arguments.
+    test_src_par_id = 50;
+    test_dst_par_id = 40;
+    test_num_ways = 30;
+    EXPECT_TRUE(run({"parmoveways", "3", "0", "4"}));
+    EXPECT_EQ(test_src_par_id, 3);
+    EXPECT_EQ(test_dst_par_id, 0);
+    EXPECT_EQ(test_num_ways, 4);
+
+    // Called with four arguments.
+    EXPECT_FALSE(run({"parmoveways", "3", "0", "4", "5"}));
+
+    // Called with an invalid argument.
+    EXPECT_FALSE(run({"parmoveways", "3", "foo"}));
+}